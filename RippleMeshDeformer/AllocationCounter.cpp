@@ -0,0 +1,89 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Zero-initialized before any constructor runs, so allocations from static initializers are counted too.
+static std::atomic<unsigned long long> allocationCount(0);
+static std::atomic<unsigned long long> allocatedBytes(0);
+
+// The counts only need to be exact once the threads meet again, so they don't order anything.
+static void* CountedAllocate(std::size_t bytes)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+
+    if (bytes == 0) {
+        bytes = 1;
+    }
+    for (;;) {
+        void* memory = std::malloc(bytes);
+        if (memory != nullptr) {
+            return memory;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+static void* CountedAllocate(std::size_t bytes, const std::nothrow_t&) noexcept
+{
+    try {
+        return CountedAllocate(bytes);
+    }
+    catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+AllocationCount GetAllocationCount()
+{
+    AllocationCount count;
+    count.allocations = allocationCount.load(std::memory_order_relaxed);
+    count.bytes = allocatedBytes.load(std::memory_order_relaxed);
+    return count;
+}
+
+void* operator new(std::size_t bytes)
+{
+    return CountedAllocate(bytes);
+}
+
+void* operator new[](std::size_t bytes)
+{
+    return CountedAllocate(bytes);
+}
+
+void* operator new(std::size_t bytes, const std::nothrow_t& tag) noexcept
+{
+    return CountedAllocate(bytes, tag);
+}
+
+void* operator new[](std::size_t bytes, const std::nothrow_t& tag) noexcept
+{
+    return CountedAllocate(bytes, tag);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+// Heap allocations made through operator new on any thread, and their bytes, since the program started.
+struct AllocationCount
+{
+    unsigned long long allocations;
+    unsigned long long bytes;
+};
+
+/**
+ * AllocationCounter.cpp replaces the global operator new and delete with versions that count every
+ * allocation before going to malloc, so a stretch of the program can be checked for heap traffic by
+ * comparing two counts. Only C++ allocations are seen: the driver, GLFW and the C library allocate
+ * with malloc directly.
+ */
+AllocationCount GetAllocationCount();
@@ -0,0 +1,85 @@
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+Arena::Arena(size_t blockBytes) :
+        _blockBytes(blockBytes),
+        _block(0),
+        _offset(0)
+{ }
+
+Arena::~Arena()
+{
+    Release();
+}
+
+void* Arena::Allocate(size_t bytes, size_t alignment)
+{
+    // Try the current block, then the blocks kept from before a rewind, and only then grow.
+    for (; _block < _blocks.size(); ++_block, _offset = 0) {
+        const Block& block = _blocks[_block];
+        const uintptr_t address = reinterpret_cast<uintptr_t>(block.data) + _offset;
+        const size_t start = _offset + ((alignment - address % alignment) % alignment);
+        if (start + bytes <= block.bytes) {
+            _offset = start + bytes;
+            return block.data + start;
+        }
+    }
+
+    // New blocks come from operator new[], aligned for any type, so the allocation starts the block.
+    Block block;
+    block.bytes = std::max(_blockBytes, bytes);
+    block.data = new unsigned char[block.bytes];
+    _blocks.push_back(block);
+    _block = _blocks.size() - 1;
+    _offset = bytes;
+    return block.data;
+}
+
+Arena::Marker Arena::GetMarker() const
+{
+    Marker marker;
+    marker.block = _block;
+    marker.offset = _offset;
+    return marker;
+}
+
+void Arena::Rewind(const Marker& marker)
+{
+    _block = marker.block;
+    _offset = marker.offset;
+}
+
+void Arena::Reset()
+{
+    _block = 0;
+    _offset = 0;
+}
+
+void Arena::Release()
+{
+    for (size_t index = 0; index < _blocks.size(); ++index) {
+        delete[] _blocks[index].data;
+    }
+    _blocks.clear();
+    Reset();
+}
+
+size_t Arena::GetUsedBytes() const
+{
+    size_t bytes = 0;
+    for (size_t index = 0; index < _block && index < _blocks.size(); ++index) {
+        bytes += _blocks[index].bytes;
+    }
+    return bytes + _offset;
+}
+
+size_t Arena::GetCapacity() const
+{
+    size_t bytes = 0;
+    for (size_t index = 0; index < _blocks.size(); ++index) {
+        bytes += _blocks[index].bytes;
+    }
+    return bytes;
+}
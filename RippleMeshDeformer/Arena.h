@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * A bump allocator for data that lives as long as a frame or a level.
+ *
+ * Allocate() only moves an offset forward in the current block; nothing is freed one allocation at a
+ * time. Rewind() drops everything allocated since a marker and Reset() everything, but both keep the
+ * blocks, so once an arena has grown to what a frame or a level needs it never goes back to the heap.
+ * Not thread-safe: give each thread its own arena.
+ */
+class Arena final
+{
+public:
+    static const size_t DEFAULT_BLOCK_BYTES = 64 * 1024;
+
+    // A point to rewind to: everything allocated after it is dropped.
+    struct Marker
+    {
+        size_t block;
+        size_t offset;
+    };
+
+    // A block holds blockBytes, or more for a larger allocation.
+    explicit Arena(size_t blockBytes = DEFAULT_BLOCK_BYTES);
+
+    Arena(const Arena& rhs) = delete;
+    Arena(Arena&& rhs) = delete;
+
+    Arena& operator=(const Arena& rhs) = delete;
+    Arena& operator=(Arena&& rhs) = delete;
+
+    ~Arena();
+
+    // Uninitialized memory; alignment must be a power of two, at most alignof(std::max_align_t).
+    void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* AllocateArray(size_t count)
+    {
+        return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    Marker GetMarker() const;
+    void Rewind(const Marker& marker);
+
+    // Drops every allocation but keeps the blocks.
+    void Reset();
+
+    // Returns the blocks to the heap.
+    void Release();
+
+    // Bytes up to the current offset, including what alignment and block ends wasted, and bytes held.
+    size_t GetUsedBytes() const;
+    size_t GetCapacity() const;
+
+private:
+    struct Block
+    {
+        unsigned char* data;
+        size_t bytes;
+    };
+
+    size_t _blockBytes;
+    std::vector<Block> _blocks;
+    size_t _block;      // block allocated from
+    size_t _offset;     // into it
+};
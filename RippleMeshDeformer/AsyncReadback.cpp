@@ -0,0 +1,177 @@
+#include "AsyncReadback.h"
+
+#include <iostream>
+
+// How long a single wait for a read's fence blocks before it is retried.
+static const GLuint64 FENCE_WAIT_TIMEOUT_NS = 1000000;
+
+AsyncReadback::AsyncReadback() :
+        _oldest(0),
+        _inFlight(0),
+        _pollCount(0),
+        _deliveredCount(0),
+        _stallCount(0),
+        _lastLatency(0)
+{
+    for (int index = 0; index < SLOT_COUNT; ++index) {
+        _slots[index].bufferId = 0;
+        _slots[index].capacity = 0;
+        _slots[index].bytes = 0;
+        _slots[index].fence = nullptr;
+        _slots[index].queuedPoll = 0;
+    }
+}
+
+AsyncReadback::~AsyncReadback()
+{
+    Delete();
+}
+
+void AsyncReadback::ReadBuffer(GLuint bufferId, GLintptr offset, GLsizeiptr bytes, const ReadbackCallback& callback)
+{
+    Slot& slot = BeginRead(bytes, callback);
+    glBindBuffer(GL_COPY_READ_BUFFER, bufferId);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_PIXEL_PACK_BUFFER, offset, 0, bytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    EndRead(slot);
+}
+
+void AsyncReadback::ReadTexture(GLuint textureId, GLenum format, GLenum type, GLsizeiptr bytes,
+                                const ReadbackCallback& callback)
+{
+    Slot& slot = BeginRead(bytes, callback);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glGetTexImage(GL_TEXTURE_2D, 0, format, type, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    EndRead(slot);
+}
+
+void AsyncReadback::ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, const ReadbackCallback& callback)
+{
+    Slot& slot = BeginRead(static_cast<GLsizeiptr>(width) * height * 4, callback);
+    glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    EndRead(slot);
+}
+
+int AsyncReadback::Poll()
+{
+    ++_pollCount;
+
+    // Reads finish in the order they were queued, so the first unfinished one ends the poll. A zero
+    // timeout only checks the fence, and flushes it to the GPU in case it is still queued.
+    int delivered = 0;
+    while (_inFlight > 0) {
+        const GLenum status = glClientWaitSync(_slots[_oldest].fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        Deliver();
+        ++delivered;
+    }
+    return delivered;
+}
+
+void AsyncReadback::Finish()
+{
+    while (_inFlight > 0) {
+        Deliver();
+    }
+}
+
+void AsyncReadback::Delete()
+{
+    for (int index = 0; index < SLOT_COUNT; ++index) {
+        Slot& slot = _slots[index];
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+        if (slot.bufferId != 0) {
+            glDeleteBuffers(1, &slot.bufferId);
+            slot.bufferId = 0;
+        }
+        slot.capacity = 0;
+        slot.callback = nullptr;
+    }
+    _oldest = 0;
+    _inFlight = 0;
+}
+
+unsigned long long AsyncReadback::GetDeliveredCount() const
+{
+    return _deliveredCount;
+}
+
+unsigned long long AsyncReadback::GetStallCount() const
+{
+    return _stallCount;
+}
+
+int AsyncReadback::GetLastLatency() const
+{
+    return _lastLatency;
+}
+
+AsyncReadback::Slot& AsyncReadback::BeginRead(GLsizeiptr bytes, const ReadbackCallback& callback)
+{
+    if (_inFlight == SLOT_COUNT) {
+        ++_stallCount;
+        Deliver();
+    }
+
+    Slot& slot = _slots[(_oldest + _inFlight) % SLOT_COUNT];
+    if (slot.bufferId == 0) {
+        glGenBuffers(1, &slot.bufferId);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.bufferId);
+
+    // Grow only, so a slot reallocates at most when the reads get larger.
+    if (slot.capacity < bytes) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+        slot.capacity = bytes;
+    }
+
+    slot.bytes = bytes;
+    slot.callback = callback;
+    slot.queuedPoll = _pollCount;
+    return slot;
+}
+
+void AsyncReadback::EndRead(Slot& slot)
+{
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++_inFlight;
+}
+
+void AsyncReadback::Deliver()
+{
+    Slot& slot = _slots[_oldest];
+
+    GLenum status;
+    do {
+        status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT_NS);
+    } while (status == GL_TIMEOUT_EXPIRED);
+    if (status == GL_WAIT_FAILED) {
+        std::cerr << "AsyncReadback::Deliver: waiting for the read's fence failed" << std::endl;
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.bufferId);
+    const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.bytes, GL_MAP_READ_BIT);
+    if (data) {
+        slot.callback(data, static_cast<size_t>(slot.bytes));
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    else {
+        std::cerr << "AsyncReadback::Deliver: Can't map the read" << std::endl;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.callback = nullptr;
+
+    _oldest = (_oldest + 1) % SLOT_COUNT;
+    --_inFlight;
+    _lastLatency = static_cast<int>(_pollCount - slot.queuedPoll);
+    ++_deliveredCount;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+// Called with the bytes of a finished readback; the data is only valid during the call, which must not
+// queue further reads. A callback small enough for std::function's own storage, such as a lambda
+// holding a pointer, is queued without allocating.
+typedef std::function<void(const void* data, size_t bytes)> ReadbackCallback;
+
+/**
+ * Reads buffers, textures and the framebuffer back to the CPU without stalling the render loop.
+ *
+ * Every read is queued on the GPU, into one of SLOT_COUNT pixel buffer objects, and a fence is placed
+ * after it; nothing waits at that point. Poll(), once per frame, checks the fences of the oldest reads
+ * without blocking, and maps and hands the finished ones to their callbacks in the order they were
+ * queued. With SLOT_COUNT frames in flight a read normally finishes a frame or two after it was queued.
+ * Only a read queued while every slot is still in flight waits, for the oldest one; GetStallCount()
+ * tells how often that happened. Reads of data written by shader image or storage buffer stores need
+ * the matching glMemoryBarrier first. Fences and pixel buffer objects are core since OpenGL 3.2.
+ */
+class AsyncReadback final
+{
+public:
+    static const int SLOT_COUNT = 3;
+
+    AsyncReadback();
+
+    AsyncReadback(const AsyncReadback& rhs) = delete;
+    AsyncReadback(AsyncReadback&& rhs) = delete;
+
+    AsyncReadback& operator=(const AsyncReadback& rhs) = delete;
+    AsyncReadback& operator=(AsyncReadback&& rhs) = delete;
+
+    ~AsyncReadback();
+
+    // Queues a copy of bytes of a buffer, from an offset. Leaves GL_COPY_READ_BUFFER unbound.
+    void ReadBuffer(GLuint bufferId, GLintptr offset, GLsizeiptr bytes, const ReadbackCallback& callback);
+
+    // Queues a read of level 0 of a 2D texture, of bytes in the given format and type. Leaves the active
+    // unit's GL_TEXTURE_2D unbound.
+    void ReadTexture(GLuint textureId, GLenum format, GLenum type, GLsizeiptr bytes, const ReadbackCallback& callback);
+
+    // Queues a read of a rectangle of the bound read framebuffer, as tightly packed GL_RGBA bytes.
+    void ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, const ReadbackCallback& callback);
+
+    // Delivers the reads that have finished, without waiting for any. Returns how many were delivered.
+    int Poll();
+
+    // Waits for and delivers every queued read.
+    void Finish();
+
+    void Delete();
+
+    // Reads delivered so far, reads that had to wait for a free slot, and Poll() calls from the last
+    // delivered read being queued to it being delivered.
+    unsigned long long GetDeliveredCount() const;
+    unsigned long long GetStallCount() const;
+    int GetLastLatency() const;
+
+private:
+    struct Slot
+    {
+        GLuint bufferId;
+        GLsizeiptr capacity;
+        GLsizeiptr bytes;
+        GLsync fence;
+        ReadbackCallback callback;
+        unsigned long long queuedPoll;
+    };
+
+    // Returns a free slot with room for bytes, bound to GL_PIXEL_PACK_BUFFER; waits for the oldest read
+    // if every slot is in flight.
+    Slot& BeginRead(GLsizeiptr bytes, const ReadbackCallback& callback);
+
+    // Places the fence after the read and unbinds the slot's buffer.
+    void EndRead(Slot& slot);
+
+    // Maps the oldest read for its callback and frees its slot.
+    void Deliver();
+
+    Slot _slots[SLOT_COUNT];
+    int _oldest;        // slot of the oldest read in flight
+    int _inFlight;      // reads in flight
+
+    unsigned long long _pollCount;
+    unsigned long long _deliveredCount;
+    unsigned long long _stallCount;
+    int _lastLatency;
+};
@@ -0,0 +1,81 @@
+#include "BakeFormat.h"
+
+#include <cstring>
+
+size_t GetValueBytes(BakeEncoding encoding)
+{
+    return encoding == BakeEncoding::Float ? sizeof(float) : sizeof(uint16_t);
+}
+
+uint16_t FloatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t magnitude = bits & 0x7FFFFFFF;
+
+    // NaN stays NaN; infinities and everything past the largest half, 65504, become infinities.
+    if (magnitude > 0x7F800000) {
+        return static_cast<uint16_t>(sign | 0x7E00);
+    }
+    if (magnitude >= 0x477FF000) {
+        return static_cast<uint16_t>(sign | 0x7C00);
+    }
+
+    // Below 2^-14 halves are subnormal: shift the mantissa, with its implicit bit, into place.
+    if (magnitude < 0x38800000) {
+        if (magnitude < 0x33000000) {
+            return static_cast<uint16_t>(sign);
+        }
+        const uint32_t exponent = magnitude >> 23;
+        const uint32_t mantissa = (magnitude & 0x007FFFFF) | 0x00800000;
+        const uint32_t shift = 126 - exponent;
+        uint32_t half = mantissa >> shift;
+
+        // Round to nearest, ties to even.
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1))) {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // Rebias the exponent and round the mantissa to 10 bits, ties to even; a carry correctly bumps the
+    // exponent.
+    const uint32_t rebiased = magnitude - 0x38000000;
+    const uint32_t half = (rebiased + 0x0FFF + ((rebiased >> 13) & 1)) >> 13;
+    return static_cast<uint16_t>(sign | half);
+}
+
+float HalfToFloat(uint16_t value)
+{
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x03FF;
+
+    uint32_t bits;
+    if (exponent == 0x1F) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else if (exponent != 0) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    else if (mantissa == 0) {
+        bits = sign;
+    }
+    else {
+        // Subnormal: normalize the mantissa.
+        uint32_t normalizedExponent = 113;
+        while ((mantissa & 0x0400) == 0) {
+            mantissa <<= 1;
+            --normalizedExponent;
+        }
+        bits = sign | (normalizedExponent << 23) | ((mantissa & 0x03FF) << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
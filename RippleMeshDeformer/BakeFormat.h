@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Start of every bake file.
+const char BAKE_MAGIC[8] = { 'R', 'M', 'B', 'A', 'K', 'E', '\0', '\0' };
+const uint32_t BAKE_VERSION = 1;
+
+// The header and every chunk start at a multiple of this, a multiple of every page size in use (4KB,
+// and 16KB on Apple silicon), so that a player can map, prefetch and release chunks page-exactly.
+const uint64_t BAKE_ALIGNMENT = 65536;
+
+// How a bake stores its heights.
+enum class BakeEncoding : uint32_t
+{
+    Float,          // 32-bit floats
+    Half            // 16-bit half floats
+};
+
+/**
+ * The header at the start of a bake file: one animation of the heights of a (quadsX + 1) x (quadsZ + 1)
+ * grid, in GridMesh vertex order, sampled frameRate times per second. All values are little-endian.
+ *
+ * The frames follow at dataOffset, in chunks of chunkFrames frames that start chunkBytes apart: frame f
+ * is at dataOffset + (f / chunkFrames) * chunkBytes + (f % chunkFrames) * columns * rows * value bytes.
+ * Every frame has the same size, so any frame can be found without an index.
+ */
+struct BakeHeader
+{
+    char magic[8];
+    uint32_t version;
+    BakeEncoding encoding;
+    uint32_t columns;
+    uint32_t rows;
+    uint32_t frameCount;
+    uint32_t frameRate;
+    uint32_t chunkFrames;
+    float sizeX;            // plane size in world units, as passed to GridMesh::Generate
+    float sizeZ;
+    uint32_t reserved;
+    uint64_t dataOffset;
+    uint64_t chunkBytes;
+};
+
+// Bytes of one stored height.
+size_t GetValueBytes(BakeEncoding encoding);
+
+// Converts to the nearest half float, and back.
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
@@ -0,0 +1,254 @@
+#include "BakePlayer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Marks _shownFrame and _currentChunk as not set.
+static const uint32_t NO_FRAME = 0xFFFFFFFF;
+
+BakePlayer::BakePlayer() :
+        _mapping(nullptr),
+        _mappingBytes(0),
+#if defined(_WIN32)
+        _fileHandle(INVALID_HANDLE_VALUE),
+        _mappingHandle(nullptr),
+#endif
+        _header(BakeHeader()),
+        _frameBytes(0),
+        _textureId(0),
+        _shownFrame(NO_FRAME),
+        _currentChunk(NO_FRAME),
+        _uploadCount(0),
+        _uploadedBytes(0)
+{ }
+
+BakePlayer::~BakePlayer()
+{
+    Close();
+}
+
+bool BakePlayer::Open(const std::string& path)
+{
+    Close();
+
+#if defined(_WIN32)
+    _fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    LARGE_INTEGER size;
+    if (_fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(_fileHandle, &size)) {
+        std::cerr << "BakePlayer::Open: Can't open " << path << std::endl;
+        Close();
+        return false;
+    }
+    _mappingBytes = static_cast<uint64_t>(size.QuadPart);
+    _mappingHandle = CreateFileMappingA(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mappingHandle != nullptr) {
+        _mapping = static_cast<const uint8_t*>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    }
+#else
+    const int file = open(path.c_str(), O_RDONLY);
+    struct stat status;
+    if (file < 0 || fstat(file, &status) != 0) {
+        std::cerr << "BakePlayer::Open: Can't open " << path << std::endl;
+        if (file >= 0) {
+            close(file);
+        }
+        return false;
+    }
+    _mappingBytes = static_cast<uint64_t>(status.st_size);
+    if (_mappingBytes >= sizeof(BakeHeader)) {
+        void* mapping = mmap(nullptr, static_cast<size_t>(_mappingBytes), PROT_READ, MAP_SHARED, file, 0);
+        _mapping = mapping != MAP_FAILED ? static_cast<const uint8_t*>(mapping) : nullptr;
+    }
+
+    // The mapping keeps the file open.
+    close(file);
+#endif
+    if (_mapping == nullptr) {
+        std::cerr << "BakePlayer::Open: Can't map " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    std::memcpy(&_header, _mapping, sizeof(_header));
+    if (std::memcmp(_header.magic, BAKE_MAGIC, sizeof(_header.magic)) != 0 || _header.version != BAKE_VERSION
+            || _header.encoding > BakeEncoding::Half) {
+        std::cerr << "BakePlayer::Open: " << path << " isn't a bake file" << std::endl;
+        Close();
+        return false;
+    }
+
+    // Every size comes from the file, so each is checked against what is left of the mapping before it
+    // is multiplied or added, and no product or sum can wrap past the check.
+    const uint64_t valueBytes = GetValueBytes(_header.encoding);
+    const uint64_t valueCount = static_cast<uint64_t>(_header.columns) * _header.rows;
+    bool isComplete = _header.columns >= 2 && _header.rows >= 2 && _header.frameCount != 0 && _header.frameRate != 0
+                      && _header.chunkFrames != 0 && _header.dataOffset >= sizeof(BakeHeader)
+                      && _header.dataOffset <= _mappingBytes && valueCount <= _mappingBytes / valueBytes;
+    if (isComplete) {
+        const uint64_t frameBytes = valueCount * valueBytes;
+        const uint64_t dataBytes = _mappingBytes - _header.dataOffset;
+        const uint64_t fullChunks = (_header.frameCount - 1) / _header.chunkFrames;
+        const uint64_t lastChunkFrames = (_header.frameCount - 1) % _header.chunkFrames + 1;
+        isComplete = _header.chunkBytes / _header.chunkFrames >= frameBytes
+                     && fullChunks <= dataBytes / _header.chunkBytes
+                     && lastChunkFrames <= (dataBytes - fullChunks * _header.chunkBytes) / frameBytes;
+        _frameBytes = static_cast<size_t>(frameBytes);
+    }
+    if (!isComplete) {
+        std::cerr << "BakePlayer::Open: " << path << " is incomplete" << std::endl;
+        Close();
+        return false;
+    }
+
+#if !defined(_WIN32)
+    // Playback walks the file front to back: read ahead, and drop pages once they have been used.
+    madvise(const_cast<uint8_t*>(_mapping), static_cast<size_t>(_mappingBytes), MADV_SEQUENTIAL);
+#endif
+    return true;
+}
+
+void BakePlayer::InitTexture()
+{
+    glGenTextures(1, &_textureId);
+    glBindTexture(GL_TEXTURE_2D, _textureId);
+    glTexImage2D(GL_TEXTURE_2D, 0, _header.encoding == BakeEncoding::Half ? GL_R16F : GL_R32F, _header.columns,
+                 _header.rows, 0, GL_RED, GL_FLOAT, nullptr);
+
+    // texelFetch only, but a texture is incomplete for it with the default mipmapped filter.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    _shownFrame = NO_FRAME;
+    ShowFrame(0);
+}
+
+void BakePlayer::ShowFrameAt(double time)
+{
+    const double frame = std::floor(time * _header.frameRate);
+    ShowFrame(static_cast<uint32_t>(std::fmod(std::max(frame, 0.0), static_cast<double>(_header.frameCount))));
+}
+
+void BakePlayer::ShowFrame(uint32_t frame)
+{
+    if (frame == _shownFrame || frame >= _header.frameCount) {
+        return;
+    }
+
+    const uint32_t chunk = frame / _header.chunkFrames;
+    if (chunk != _currentChunk) {
+        EnterChunk(chunk);
+    }
+
+    const GLenum type = _header.encoding == BakeEncoding::Float ? GL_FLOAT : GL_HALF_FLOAT;
+    _uploadedBytes += _frameBytes;
+
+    // Rows of half floats are only 2-byte aligned.
+    glBindTexture(GL_TEXTURE_2D, _textureId);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, type == GL_FLOAT ? 4 : 2);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _header.columns, _header.rows, GL_RED, type, GetFrameData(frame));
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    _shownFrame = frame;
+    ++_uploadCount;
+}
+
+void BakePlayer::Close()
+{
+    if (_textureId != 0) {
+        glDeleteTextures(1, &_textureId);
+        _textureId = 0;
+    }
+
+#if defined(_WIN32)
+    if (_mapping != nullptr) {
+        UnmapViewOfFile(_mapping);
+    }
+    if (_mappingHandle != nullptr) {
+        CloseHandle(_mappingHandle);
+        _mappingHandle = nullptr;
+    }
+    if (_fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(_fileHandle);
+        _fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (_mapping != nullptr) {
+        munmap(const_cast<uint8_t*>(_mapping), static_cast<size_t>(_mappingBytes));
+    }
+#endif
+    _mapping = nullptr;
+    _mappingBytes = 0;
+
+    _shownFrame = NO_FRAME;
+    _currentChunk = NO_FRAME;
+}
+
+const BakeHeader& BakePlayer::GetHeader() const
+{
+    return _header;
+}
+
+GLuint BakePlayer::GetHeightTextureId() const
+{
+    return _textureId;
+}
+
+long long BakePlayer::GetTextureBytes() const
+{
+    return static_cast<long long>(_header.columns) * _header.rows
+           * (_header.encoding == BakeEncoding::Half ? 2 : 4);
+}
+
+unsigned long long BakePlayer::GetUploadCount() const
+{
+    return _uploadCount;
+}
+
+unsigned long long BakePlayer::GetUploadedBytes() const
+{
+    return _uploadedBytes;
+}
+
+const uint8_t* BakePlayer::GetFrameData(uint32_t frame) const
+{
+    return _mapping + _header.dataOffset + static_cast<uint64_t>(frame / _header.chunkFrames) * _header.chunkBytes
+           + static_cast<uint64_t>(frame % _header.chunkFrames) * _frameBytes;
+}
+
+void BakePlayer::EnterChunk(uint32_t chunk)
+{
+#if !defined(_WIN32)
+    // Chunks are aligned to BAKE_ALIGNMENT, so these ranges start on page boundaries. The last chunk
+    // may be shorter; the ranges are clipped to the mapping.
+    const uint32_t chunkCount = (_header.frameCount + _header.chunkFrames - 1) / _header.chunkFrames;
+    const size_t chunkBytes = static_cast<size_t>(_header.chunkBytes);
+    uint8_t* data = const_cast<uint8_t*>(_mapping) + _header.dataOffset;
+    const uint64_t dataBytes = _mappingBytes - _header.dataOffset;
+
+    const uint32_t next = chunk + 1 < chunkCount ? chunk + 1 : 0;
+    const uint64_t nextOffset = static_cast<uint64_t>(next) * chunkBytes;
+    madvise(data + nextOffset, static_cast<size_t>(std::min<uint64_t>(chunkBytes, dataBytes - nextOffset)), MADV_WILLNEED);
+
+    if (_currentChunk != NO_FRAME && _currentChunk != next) {
+        const uint64_t previousOffset = static_cast<uint64_t>(_currentChunk) * chunkBytes;
+        madvise(data + previousOffset, static_cast<size_t>(std::min<uint64_t>(chunkBytes, dataBytes - previousOffset)),
+                MADV_DONTNEED);
+    }
+#endif
+    // On Windows the working set is trimmed by the memory manager; file-backed pages are reclaimed first.
+
+    _currentChunk = chunk;
+}
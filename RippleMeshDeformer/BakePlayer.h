@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+#include "BakeFormat.h"
+
+/**
+ * Plays a bake file back into a height texture, drawn like the heights of WaveSimulation.
+ *
+ * The file is memory-mapped rather than read, and frames go from the mapping straight to
+ * glTexSubImage2D, so the driver's upload is the only copy a frame ever sees. Only the chunk being
+ * played and the next one are kept resident: entering a chunk asks the OS to read the next one ahead
+ * and releases the one before, so a bake much larger than memory plays back in a few chunks' worth of
+ * it.
+ */
+class BakePlayer final
+{
+public:
+    BakePlayer();
+
+    BakePlayer(const BakePlayer& rhs) = delete;
+    BakePlayer(BakePlayer&& rhs) = delete;
+
+    BakePlayer& operator=(const BakePlayer& rhs) = delete;
+    BakePlayer& operator=(BakePlayer&& rhs) = delete;
+
+    ~BakePlayer();
+
+    // Maps a bake file and checks its header and size. Needs no context, so the grid can be sized from
+    // the header first. Returns false if the file can't be mapped or isn't a complete bake.
+    bool Open(const std::string& path);
+
+    // Creates the height texture, with the first frame in it. Needs a current context.
+    void InitTexture();
+
+    // Shows a frame: the one at a time in seconds from the start, looping over the animation.
+    void ShowFrameAt(double time);
+
+    // Uploads a frame into the height texture, unless it is there already.
+    void ShowFrame(uint32_t frame);
+
+    // Deletes the texture and unmaps the file.
+    void Close();
+
+    const BakeHeader& GetHeader() const;
+
+    // The shown frame's heights, a GL_R32F or, for Half, GL_R16F texture with one texel per grid point.
+    GLuint GetHeightTextureId() const;
+    long long GetTextureBytes() const;
+
+    // Frames uploaded, and the bytes the uploads read from the mapping.
+    unsigned long long GetUploadCount() const;
+    unsigned long long GetUploadedBytes() const;
+
+private:
+    const uint8_t* GetFrameData(uint32_t frame) const;
+
+    // Prefetches the chunk after a chunk, and releases the one before it.
+    void EnterChunk(uint32_t chunk);
+
+    const uint8_t* _mapping;
+    uint64_t _mappingBytes;
+#if defined(_WIN32)
+    void* _fileHandle;
+    void* _mappingHandle;
+#endif
+
+    BakeHeader _header;
+    size_t _frameBytes;
+
+    GLuint _textureId;
+    uint32_t _shownFrame;
+    uint32_t _currentChunk;
+
+    unsigned long long _uploadCount;
+    unsigned long long _uploadedBytes;
+};
@@ -0,0 +1,127 @@
+#include "BakeWriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+BakeWriter::BakeWriter() :
+        _header(BakeHeader()),
+        _fileBytes(0)
+{ }
+
+BakeWriter::~BakeWriter()
+{
+    Close();
+}
+
+bool BakeWriter::Open(const std::string& path, int columns, int rows, float sizeX, float sizeZ, int frameRate,
+                      BakeEncoding encoding)
+{
+    Close();
+
+    _header = BakeHeader();
+    std::memcpy(_header.magic, BAKE_MAGIC, sizeof(_header.magic));
+    _header.version = BAKE_VERSION;
+    _header.encoding = encoding;
+    _header.columns = static_cast<uint32_t>(columns);
+    _header.rows = static_cast<uint32_t>(rows);
+    _header.frameRate = static_cast<uint32_t>(frameRate);
+    _header.chunkFrames = CHUNK_FRAMES;
+    _header.sizeX = sizeX;
+    _header.sizeZ = sizeZ;
+    _header.dataOffset = BAKE_ALIGNMENT;
+
+    const uint64_t frameBytes = static_cast<uint64_t>(columns) * rows * GetValueBytes(encoding);
+    _header.chunkBytes = (frameBytes * CHUNK_FRAMES + BAKE_ALIGNMENT - 1) / BAKE_ALIGNMENT * BAKE_ALIGNMENT;
+
+    _file.open(path.c_str(), std::ios::binary | std::ios::trunc);
+    _file.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+    _fileBytes = sizeof(_header);
+    if (!_file || !WritePadding(_header.dataOffset)) {
+        std::cerr << "BakeWriter::Open: Can't write " << path << std::endl;
+        _file.close();
+        return false;
+    }
+
+    _path = path;
+    _halves.assign(encoding == BakeEncoding::Float ? 0 : static_cast<size_t>(columns) * rows, 0);
+    return true;
+}
+
+bool BakeWriter::WriteFrame(const float* heights)
+{
+    if (!_file.is_open()) {
+        return false;
+    }
+
+    // Chunks start at their aligned offsets, after the previous chunk's padding.
+    const uint32_t frameInChunk = _header.frameCount % _header.chunkFrames;
+    if (frameInChunk == 0 && !WritePadding(_header.dataOffset + (_header.frameCount / _header.chunkFrames) * _header.chunkBytes)) {
+        std::cerr << "BakeWriter::WriteFrame: Can't write " << _path << std::endl;
+        _file.close();
+        return false;
+    }
+
+    const size_t count = static_cast<size_t>(_header.columns) * _header.rows;
+    if (_header.encoding == BakeEncoding::Float) {
+        _file.write(reinterpret_cast<const char*>(heights), static_cast<std::streamsize>(count * sizeof(float)));
+    }
+    else {
+        for (size_t index = 0; index < count; ++index) {
+            _halves[index] = FloatToHalf(heights[index]);
+        }
+        _file.write(reinterpret_cast<const char*>(_halves.data()), static_cast<std::streamsize>(count * sizeof(uint16_t)));
+    }
+
+    if (!_file) {
+        std::cerr << "BakeWriter::WriteFrame: Can't write " << _path << std::endl;
+        _file.close();
+        return false;
+    }
+
+    _fileBytes += count * GetValueBytes(_header.encoding);
+    ++_header.frameCount;
+    return true;
+}
+
+bool BakeWriter::Close()
+{
+    if (!_file.is_open()) {
+        return true;
+    }
+
+    _file.seekp(0);
+    _file.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+    _file.close();
+    if (!_file) {
+        std::cerr << "BakeWriter::Close: Can't write " << _path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool BakeWriter::IsOpen() const
+{
+    return _file.is_open();
+}
+
+uint32_t BakeWriter::GetFrameCount() const
+{
+    return _header.frameCount;
+}
+
+uint64_t BakeWriter::GetFileBytes() const
+{
+    return _fileBytes;
+}
+
+bool BakeWriter::WritePadding(uint64_t offset)
+{
+    static const char zeros[4096] = {};
+    while (_fileBytes < offset) {
+        const uint64_t bytes = std::min<uint64_t>(offset - _fileBytes, sizeof(zeros));
+        _file.write(zeros, static_cast<std::streamsize>(bytes));
+        _fileBytes += bytes;
+    }
+    return static_cast<bool>(_file);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "BakeFormat.h"
+
+/**
+ * Streams frames of grid heights into a bake file (see BakeHeader), one frame at a time, so a bake of
+ * any length only ever holds a frame in memory.
+ *
+ * Frames are encoded as they arrive and appended to the file; the header is written with a frame count
+ * of 0 first and rewritten by Close(), so a bake cut short by a crash is recognizably incomplete.
+ */
+class BakeWriter final
+{
+public:
+    // Frames per chunk: a second of animation at 60 frames per second.
+    static const uint32_t CHUNK_FRAMES = 60;
+
+    BakeWriter();
+
+    BakeWriter(const BakeWriter& rhs) = delete;
+    BakeWriter(BakeWriter&& rhs) = delete;
+
+    BakeWriter& operator=(const BakeWriter& rhs) = delete;
+    BakeWriter& operator=(BakeWriter&& rhs) = delete;
+
+    ~BakeWriter();
+
+    // Creates the file, replacing any earlier one, for frames of columns x rows heights of a sizeX x
+    // sizeZ plane. Returns false if it can't be written.
+    bool Open(const std::string& path, int columns, int rows, float sizeX, float sizeZ, int frameRate,
+              BakeEncoding encoding);
+
+    // Appends a frame of columns x rows heights, in GridMesh vertex order. Returns false if the write
+    // failed; the file is then closed.
+    bool WriteFrame(const float* heights);
+
+    // Writes the final header. Returns false if that failed; called by the destructor otherwise.
+    bool Close();
+
+    bool IsOpen() const;
+
+    uint32_t GetFrameCount() const;
+
+    // Bytes written to the file so far, the padding included.
+    uint64_t GetFileBytes() const;
+
+private:
+    bool WritePadding(uint64_t offset);
+
+    std::ofstream _file;
+    std::string _path;
+    BakeHeader _header;
+
+    // One encoded Half frame.
+    std::vector<uint16_t> _halves;
+
+    uint64_t _fileBytes;
+};
@@ -0,0 +1,186 @@
+#include "Benchmark.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+BenchmarkResult::BenchmarkResult() :
+        quadsX(0),
+        quadsZ(0),
+        meshSource(MeshSource::Indexed),
+        indexLayout(IndexLayout::Triangles),
+        vertexFormat(VertexFormat::Float),
+        deformPath(DeformPath::Vertex),
+        shading(Shading::Wireframe),
+        farFieldStart(0.0f),
+        farFieldEnd(0.0f),
+        emitterCount(0),
+        instanceCount(0),
+        cullTileQuads(0),
+        vertexCount(0),
+        frames(0),
+        averageMilliseconds(0.0),
+        percentile99Milliseconds(0.0),
+        gpuAverageMilliseconds(0.0),
+        bufferBytes(0)
+{ }
+
+static const char* CSV_HEADER =
+        "quads_x,quads_z,mesh,layout,vertex_format,deform,shading,far_field_start,far_field_end,emitters,instances,cull,vertices,frames,"
+        "ms_avg,ms_p99,gpu_ms_avg,vertices_per_second,buffer_bytes,renderer";
+
+// Vertices per second at the average frame time.
+static unsigned long long GetVerticesPerSecond(const BenchmarkResult& result)
+{
+    return result.averageMilliseconds > 0.0
+           ? static_cast<unsigned long long>(result.vertexCount * 1000.0 / result.averageMilliseconds) : 0;
+}
+
+// Quotes a string for CSV (doubling embedded quotes) or JSON (escaping quotes and backslashes).
+static std::string Quote(const std::string& text, BenchmarkFormat format)
+{
+    std::string quoted = "\"";
+    for (size_t index = 0; index < text.size(); ++index) {
+        if (text[index] == '"') {
+            quoted += format == BenchmarkFormat::Csv ? "\"\"" : "\\\"";
+        }
+        else if (text[index] == '\\' && format == BenchmarkFormat::Json) {
+            quoted += "\\\\";
+        }
+        else {
+            quoted += text[index];
+        }
+    }
+    return quoted + "\"";
+}
+
+static void WriteCsvRow(std::ostream& stream, const BenchmarkResult& result)
+{
+    stream << result.quadsX << "," << result.quadsZ << "," << GetOptionName(result.meshSource) << ","
+           << GetOptionName(result.indexLayout) << "," << GetOptionName(result.vertexFormat) << ","
+           << GetOptionName(result.deformPath) << "," << GetOptionName(result.shading) << ","
+           << result.farFieldStart << "," << result.farFieldEnd << "," << result.emitterCount << "," << result.instanceCount << ","
+           << result.cullTileQuads << "," << result.vertexCount << "," << result.frames << ","
+           << result.averageMilliseconds << "," << result.percentile99Milliseconds << ","
+           << result.gpuAverageMilliseconds << "," << GetVerticesPerSecond(result) << "," << result.bufferBytes << ","
+           << Quote(result.renderer, BenchmarkFormat::Csv) << "\n";
+}
+
+static void WriteJsonLine(std::ostream& stream, const BenchmarkResult& result)
+{
+    stream << "{\"quads_x\": " << result.quadsX << ", \"quads_z\": " << result.quadsZ
+           << ", \"mesh\": \"" << GetOptionName(result.meshSource)
+           << "\", \"layout\": \"" << GetOptionName(result.indexLayout)
+           << "\", \"vertex_format\": \"" << GetOptionName(result.vertexFormat)
+           << "\", \"deform\": \"" << GetOptionName(result.deformPath)
+           << "\", \"shading\": \"" << GetOptionName(result.shading)
+           << "\", \"far_field_start\": " << result.farFieldStart << ", \"far_field_end\": " << result.farFieldEnd
+           << ", \"emitters\": " << result.emitterCount << ", \"instances\": " << result.instanceCount
+           << ", \"cull\": " << result.cullTileQuads << ", \"vertices\": " << result.vertexCount
+           << ", \"frames\": " << result.frames << ", \"ms_avg\": " << result.averageMilliseconds
+           << ", \"ms_p99\": " << result.percentile99Milliseconds << ", \"gpu_ms_avg\": " << result.gpuAverageMilliseconds
+           << ", \"vertices_per_second\": " << GetVerticesPerSecond(result) << ", \"buffer_bytes\": " << result.bufferBytes
+           << ", \"renderer\": " << Quote(result.renderer, BenchmarkFormat::Json) << "}\n";
+}
+
+bool WriteBenchmarkResult(const BenchmarkResult& result, const std::string& path, BenchmarkFormat format)
+{
+    if (path.empty()) {
+        if (format == BenchmarkFormat::Csv) {
+            std::cout << CSV_HEADER << "\n";
+            WriteCsvRow(std::cout, result);
+        }
+        else {
+            WriteJsonLine(std::cout, result);
+        }
+        std::cout << std::flush;
+        return true;
+    }
+
+    // A CSV file gets its header when it is first written, so runs can keep appending to it.
+    bool isEmpty = true;
+    {
+        std::ifstream existing(path);
+        isEmpty = !existing || existing.peek() == std::ifstream::traits_type::eof();
+    }
+
+    std::ofstream file(path, std::ios::app);
+    if (!file) {
+        std::cerr << "WriteBenchmarkResult: Can't open " << path << std::endl;
+        return false;
+    }
+
+    if (format == BenchmarkFormat::Csv) {
+        if (isEmpty) {
+            file << CSV_HEADER << "\n";
+        }
+        WriteCsvRow(file, result);
+    }
+    else {
+        WriteJsonLine(file, result);
+    }
+
+    return static_cast<bool>(file);
+}
+
+bool RunBenchmarkSweep(const char* programPath, const Options& options)
+{
+    std::string output = options.benchmarkOutput;
+    if (output.empty()) {
+        output = options.benchmarkFormat == BenchmarkFormat::Csv ? "benchmark.csv" : "benchmark.jsonl";
+    }
+
+    std::ostringstream common;
+    common << " --benchmark " << options.benchmarkSweepFrames << " --benchmark-output \"" << output << "\""
+           << " --benchmark-format " << (options.benchmarkFormat == BenchmarkFormat::Csv ? "csv" : "json");
+
+    // Every resolution with each layout and format of the vertex path, and each per-frame deformation pass.
+    // Lit runs compare the analytic normals of the vertex path with the finite differences of compute.
+    std::vector<std::string> configurations;
+    const int resolutions[] = { 64, 256, 1024 };
+    for (size_t index = 0; index < sizeof(resolutions) / sizeof(resolutions[0]); ++index) {
+        std::ostringstream quads;
+        quads << "--quads " << resolutions[index] << "x" << resolutions[index];
+
+        configurations.push_back(quads.str() + " --layout triangles --vertex-format float");
+        configurations.push_back(quads.str() + " --layout triangles --vertex-format quantized");
+        configurations.push_back(quads.str() + " --layout strips --vertex-format float");
+        configurations.push_back(quads.str() + " --layout strips --vertex-format quantized");
+        configurations.push_back(quads.str() + " --deform compute");
+        configurations.push_back(quads.str() + " --deform feedback");
+        configurations.push_back(quads.str() + " --deform cpu");
+        configurations.push_back(quads.str() + " --shading lit");
+        configurations.push_back(quads.str() + " --deform compute --shading lit");
+    }
+
+    // Tessellation refines a coarse grid on the GPU.
+    configurations.push_back("--quads 16x16 --deform tessellation");
+
+    // The lit far field: geometry near the camera and per-pixel normals past it, on a coarse grid and on
+    // patches that drop to their coarsest level once flat, against the same surfaces fully displaced.
+    configurations.push_back("--quads 64x64 --shading lit --far-field 4,6");
+    configurations.push_back("--mesh patches --shading lit");
+    configurations.push_back("--mesh patches --shading lit --far-field 4,8");
+
+    // The wave equation, stepping one 60 Hz frame's worth per frame, up to the largest grid it targets.
+    configurations.push_back("--quads 1024x1024 --deform simulation");
+    configurations.push_back("--quads 4096x4096 --deform simulation");
+    configurations.push_back("--quads 4096x4096 --deform simulation --simulation-rate 960");
+
+    int failures = 0;
+    for (size_t index = 0; index < configurations.size(); ++index) {
+        std::cout << "Benchmark " << index + 1 << "/" << configurations.size() << ": " << configurations[index] << std::endl;
+
+        const std::string command = "\"" + std::string(programPath) + "\" " + configurations[index] + common.str();
+        if (std::system(command.c_str()) != 0) {
+            std::cerr << "RunBenchmarkSweep: Failed: " << configurations[index] << std::endl;
+            ++failures;
+        }
+    }
+
+    std::cout << "Benchmark results appended to " << output << ", " << failures << " of " << configurations.size()
+              << " configurations failed" << std::endl;
+    return failures == 0;
+}
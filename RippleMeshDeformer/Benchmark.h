@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+
+#include "Options.h"
+
+// One benchmark run: the configuration it rendered and what it measured.
+struct BenchmarkResult
+{
+    BenchmarkResult();
+
+    int quadsX;
+    int quadsZ;
+    MeshSource meshSource;
+    IndexLayout indexLayout;
+    VertexFormat vertexFormat;
+    DeformPath deformPath;
+    Shading shading;
+    float farFieldStart;
+    float farFieldEnd;
+    int emitterCount;
+    int instanceCount;
+    int cullTileQuads;
+
+    // Vertices drawn per frame, over every instance.
+    unsigned long long vertexCount;
+
+    int frames;
+    double averageMilliseconds;
+    double percentile99Milliseconds;
+    double gpuAverageMilliseconds;
+
+    // Bytes of the buffers allocated for the mesh and its deformation, an estimate of their share of VRAM.
+    long long bufferBytes;
+
+    std::string renderer;
+};
+
+// Appends a result to a file, after a header line for a new CSV file, or prints it to the console if the
+// path is empty. Returns false if the file couldn't be written.
+bool WriteBenchmarkResult(const BenchmarkResult& result, const std::string& path, BenchmarkFormat format);
+
+// Benchmarks a fixed set of resolutions, index layouts, vertex formats, deformation paths and shadings, each in
+// a child process of the given program so that every run starts from a fresh context. The results are
+// appended to the options' benchmark output, benchmark.csv (or .jsonl) by default.
+bool RunBenchmarkSweep(const char* programPath, const Options& options);
@@ -0,0 +1,37 @@
+#version 330 core
+
+// Evaluates the ripple of Vertex.shader for every grid point and hands the result to transform
+// feedback instead of the rasterizer. The position and analytic normal are captured interleaved,
+// matching DeformedVertex in DeformedVertex.h.
+
+layout (location = 0) in vec3 vertex;    // use location so we don't need to call glBindAttribLocation(...)
+
+layout (std140) uniform FrameUniforms  // filled from the FrameUniforms struct in FrameUniforms.h
+{
+    mat4 modelViewProjectMatrix;
+    vec4 newColor;
+    vec2 waveCenter;
+    float waveTime;
+    float amplitude;
+    float frequency;
+};
+
+out vec4 deformedPosition;
+out vec4 deformedNormal;
+
+const float PI = 3.14159;
+
+void main()
+{
+    vec2 offset = vertex.xz - waveCenter;
+    float distance = length(offset);
+    float phase = -PI * distance * frequency + waveTime;
+    float y = amplitude * sin(phase);
+
+    // The height only depends on the distance, so the slope is d(y)/d(distance) along the offset.
+    float slope = -amplitude * PI * frequency * cos(phase);
+    vec2 gradient = distance > 0 ? slope * offset / distance : vec2(0);
+
+    deformedPosition = vec4(vertex.x, y, vertex.z, 1);
+    deformedNormal = vec4(normalize(vec3(-gradient.x, 1, -gradient.y)), 0);
+}
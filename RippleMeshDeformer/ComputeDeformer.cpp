@@ -0,0 +1,67 @@
+#include "ComputeDeformer.h"
+
+ComputeDeformer::ComputeDeformer() :
+        _deformedVerticesId(0),
+        _quadsX(0),
+        _quadsZ(0)
+{ }
+
+ComputeDeformer::~ComputeDeformer()
+{
+    Delete();
+}
+
+bool ComputeDeformer::Init(const std::string& shaderPath, int quadsX, int quadsZ, float sizeX, float sizeZ,
+                           GLuint frameUniformsBinding)
+{
+    _quadsX = quadsX;
+    _quadsZ = quadsZ;
+
+    _computeProgram.AddShaderFromFile(GL_COMPUTE_SHADER, shaderPath);
+    _computeProgram.CreateAndLinkProgram();
+    if (!_computeProgram.IsCreated()) {
+        return false;
+    }
+
+    // The ripple parameters come from the same per-frame uniform buffer as the drawing programs.
+    _computeProgram.BindUniformBlock("FrameUniforms", frameUniformsBinding);
+
+    _computeProgram.UseProgram();
+    _computeProgram.GetUniformHandle<glm::ivec2>("gridQuads").Set(glm::ivec2(quadsX, quadsZ));
+    _computeProgram.GetUniformHandle<glm::vec2>("gridSize").Set(glm::vec2(sizeX, sizeZ));
+
+    const GLsizeiptr size = static_cast<GLsizeiptr>(quadsX + 1) * (quadsZ + 1) * sizeof(DeformedVertex);
+
+    glGenBuffers(1, &_deformedVerticesId);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _deformedVerticesId);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DEFORMED_VERTICES_BINDING, _deformedVerticesId);
+
+    return true;
+}
+
+void ComputeDeformer::Deform()
+{
+    _computeProgram.UseProgram();
+
+    // One invocation per grid point, rounded up to whole work groups.
+    glDispatchCompute((_quadsX + WORK_GROUP_SIZE) / WORK_GROUP_SIZE, (_quadsZ + WORK_GROUP_SIZE) / WORK_GROUP_SIZE, 1);
+
+    // Make the writes visible to the vertex fetches of the passes drawing from the buffer.
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
+
+void ComputeDeformer::Delete()
+{
+    if (_deformedVerticesId != 0) {
+        glDeleteBuffers(1, &_deformedVerticesId);
+        _deformedVerticesId = 0;
+    }
+}
+
+GLuint ComputeDeformer::GetBufferId() const
+{
+    return _deformedVerticesId;
+}
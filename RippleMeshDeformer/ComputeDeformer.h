@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+#include "DeformedVertex.h"
+#include "GLSLProgram.h"
+
+// Shader storage buffer binding point of the deformed vertices written by DeformCompute.shader.
+const unsigned int DEFORMED_VERTICES_BINDING = 3;
+
+/**
+ * Deforms the grid once per frame with a compute shader.
+ *
+ * The compute pass writes a position and a finite-difference normal for every grid point into a
+ * buffer, ordered like the GridMesh vertices. Every later pass draws from that buffer, with the
+ * usual GridMesh index buffer, instead of evaluating the ripple again in its vertex shader.
+ * Compute shaders need OpenGL 4.3.
+ */
+class ComputeDeformer final
+{
+public:
+    // Work group size of DeformCompute.shader along x and z.
+    static const int WORK_GROUP_SIZE = 16;
+
+    ComputeDeformer();
+
+    ComputeDeformer(const ComputeDeformer& rhs) = delete;
+    ComputeDeformer(ComputeDeformer&& rhs) = delete;
+
+    ComputeDeformer& operator=(const ComputeDeformer& rhs) = delete;
+    ComputeDeformer& operator=(ComputeDeformer&& rhs) = delete;
+
+    ~ComputeDeformer();
+
+    // Builds the compute program and allocates the output buffer; returns false if the program didn't link.
+    bool Init(const std::string& shaderPath, int quadsX, int quadsZ, float sizeX, float sizeZ, GLuint frameUniformsBinding);
+
+    // Runs the deformation for the current frame uniforms. Leaves the compute program in use.
+    void Deform();
+
+    void Delete();
+
+    // The deformed vertices, one DeformedVertex per grid point.
+    GLuint GetBufferId() const;
+
+private:
+    GLSLProgram _computeProgram;
+
+    GLuint _deformedVerticesId;
+
+    int _quadsX;
+    int _quadsZ;
+};
@@ -0,0 +1,371 @@
+#include "CpuDeformer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ThreadPool.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#define RIPPLE_HAS_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__)
+// GCC and Clang can build the AVX2 kernel alone for AVX2, leaving the rest of the program baseline x86.
+#define RIPPLE_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define RIPPLE_HAS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Same value as in Vertex.shader, so both sides compute the same phase.
+static const float PI = 3.14159f;
+
+// Constants of the SIMD sine: the phase is reduced to [-pi, pi] around the nearest multiple of 2 pi
+// (with 2 pi split in two so the reduction stays exact), folded into [-pi/2, pi/2] with
+// sin(x) = sin(pi - x), and evaluated with the degree 11 Taylor polynomial, good to about 1e-7.
+static const float INV_TWO_PI = 0.15915494309189535f;
+static const float TWO_PI_HI = 6.28125f;
+static const float TWO_PI_LO = 0.0019353071795864769f;
+static const float SIN_PI = 3.14159265358979324f;
+static const float SIN_HALF_PI = 1.57079632679489662f;
+static const float SIN_C3 = -1.0f / 6.0f;
+static const float SIN_C5 = 1.0f / 120.0f;
+static const float SIN_C7 = -1.0f / 5040.0f;
+static const float SIN_C9 = 1.0f / 362880.0f;
+static const float SIN_C11 = -1.0f / 39916800.0f;
+
+// Parameters of one deformation, shared by all kernels.
+struct Ripple
+{
+    float centerX;
+    float centerZ;
+    float amplitude;
+    float phaseScale;   // -PI * frequency
+    float waveTime;
+};
+
+typedef void (*DeformKernel)(const float* x, const float* z, float* heights, size_t count, const Ripple& ripple);
+
+// The SIMD sine for a single value; used for the elements left over after the last full register.
+static inline float ApproximateSin(float x)
+{
+    float k = std::floor(x * INV_TWO_PI + 0.5f);
+    float r = (x - k * TWO_PI_HI) - k * TWO_PI_LO;
+    if (r > SIN_HALF_PI) {
+        r = SIN_PI - r;
+    }
+    else if (r < -SIN_HALF_PI) {
+        r = -SIN_PI - r;
+    }
+    float r2 = r * r;
+    return r + r * r2 * (SIN_C3 + r2 * (SIN_C5 + r2 * (SIN_C7 + r2 * (SIN_C9 + r2 * SIN_C11))));
+}
+
+static inline float ApproximateHeight(float x, float z, const Ripple& ripple)
+{
+    float dx = x - ripple.centerX;
+    float dz = z - ripple.centerZ;
+    return ripple.amplitude * ApproximateSin(std::sqrt(dx * dx + dz * dz) * ripple.phaseScale + ripple.waveTime);
+}
+
+// Reference kernel, using the C library sine.
+static void DeformScalar(const float* x, const float* z, float* heights, size_t count, const Ripple& ripple)
+{
+    for (size_t index = 0; index < count; ++index) {
+        float dx = x[index] - ripple.centerX;
+        float dz = z[index] - ripple.centerZ;
+        heights[index] = ripple.amplitude * std::sin(std::sqrt(dx * dx + dz * dz) * ripple.phaseScale + ripple.waveTime);
+    }
+}
+
+#if defined(RIPPLE_HAS_SSE2)
+static inline __m128 SelectSse2(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static void DeformSse2(const float* x, const float* z, float* heights, size_t count, const Ripple& ripple)
+{
+    const __m128 centerX = _mm_set1_ps(ripple.centerX);
+    const __m128 centerZ = _mm_set1_ps(ripple.centerZ);
+    const __m128 amplitude = _mm_set1_ps(ripple.amplitude);
+    const __m128 phaseScale = _mm_set1_ps(ripple.phaseScale);
+    const __m128 waveTime = _mm_set1_ps(ripple.waveTime);
+
+    size_t index = 0;
+    for (; index + 4 <= count; index += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + index), centerX);
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(z + index), centerZ);
+        __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz)));
+        __m128 phase = _mm_add_ps(_mm_mul_ps(distance, phaseScale), waveTime);
+
+        // Round to nearest with the default MXCSR rounding mode.
+        __m128 k = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(phase, _mm_set1_ps(INV_TWO_PI))));
+        __m128 r = _mm_sub_ps(_mm_sub_ps(phase, _mm_mul_ps(k, _mm_set1_ps(TWO_PI_HI))), _mm_mul_ps(k, _mm_set1_ps(TWO_PI_LO)));
+        r = SelectSse2(_mm_cmpgt_ps(r, _mm_set1_ps(SIN_HALF_PI)), _mm_sub_ps(_mm_set1_ps(SIN_PI), r), r);
+        r = SelectSse2(_mm_cmplt_ps(r, _mm_set1_ps(-SIN_HALF_PI)), _mm_sub_ps(_mm_set1_ps(-SIN_PI), r), r);
+
+        __m128 r2 = _mm_mul_ps(r, r);
+        __m128 p = _mm_add_ps(_mm_set1_ps(SIN_C9), _mm_mul_ps(r2, _mm_set1_ps(SIN_C11)));
+        p = _mm_add_ps(_mm_set1_ps(SIN_C7), _mm_mul_ps(r2, p));
+        p = _mm_add_ps(_mm_set1_ps(SIN_C5), _mm_mul_ps(r2, p));
+        p = _mm_add_ps(_mm_set1_ps(SIN_C3), _mm_mul_ps(r2, p));
+        __m128 sine = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), p));
+
+        _mm_storeu_ps(heights + index, _mm_mul_ps(amplitude, sine));
+    }
+
+    for (; index < count; ++index) {
+        heights[index] = ApproximateHeight(x[index], z[index], ripple);
+    }
+}
+#endif
+
+#if defined(RIPPLE_HAS_AVX2)
+__attribute__((target("avx2,fma")))
+static void DeformAvx2(const float* x, const float* z, float* heights, size_t count, const Ripple& ripple)
+{
+    const __m256 centerX = _mm256_set1_ps(ripple.centerX);
+    const __m256 centerZ = _mm256_set1_ps(ripple.centerZ);
+    const __m256 amplitude = _mm256_set1_ps(ripple.amplitude);
+    const __m256 phaseScale = _mm256_set1_ps(ripple.phaseScale);
+    const __m256 waveTime = _mm256_set1_ps(ripple.waveTime);
+
+    size_t index = 0;
+    for (; index + 8 <= count; index += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + index), centerX);
+        __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(z + index), centerZ);
+        __m256 distance = _mm256_sqrt_ps(_mm256_fmadd_ps(dx, dx, _mm256_mul_ps(dz, dz)));
+        __m256 phase = _mm256_fmadd_ps(distance, phaseScale, waveTime);
+
+        __m256 k = _mm256_round_ps(_mm256_mul_ps(phase, _mm256_set1_ps(INV_TWO_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256 r = _mm256_fnmadd_ps(k, _mm256_set1_ps(TWO_PI_LO), _mm256_fnmadd_ps(k, _mm256_set1_ps(TWO_PI_HI), phase));
+        r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(SIN_PI), r), _mm256_cmp_ps(r, _mm256_set1_ps(SIN_HALF_PI), _CMP_GT_OQ));
+        r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(-SIN_PI), r), _mm256_cmp_ps(r, _mm256_set1_ps(-SIN_HALF_PI), _CMP_LT_OQ));
+
+        __m256 r2 = _mm256_mul_ps(r, r);
+        __m256 p = _mm256_fmadd_ps(r2, _mm256_set1_ps(SIN_C11), _mm256_set1_ps(SIN_C9));
+        p = _mm256_fmadd_ps(r2, p, _mm256_set1_ps(SIN_C7));
+        p = _mm256_fmadd_ps(r2, p, _mm256_set1_ps(SIN_C5));
+        p = _mm256_fmadd_ps(r2, p, _mm256_set1_ps(SIN_C3));
+        __m256 sine = _mm256_fmadd_ps(_mm256_mul_ps(r, r2), p, r);
+
+        _mm256_storeu_ps(heights + index, _mm256_mul_ps(amplitude, sine));
+    }
+
+    for (; index < count; ++index) {
+        heights[index] = ApproximateHeight(x[index], z[index], ripple);
+    }
+}
+#endif
+
+#if defined(RIPPLE_HAS_NEON)
+static void DeformNeon(const float* x, const float* z, float* heights, size_t count, const Ripple& ripple)
+{
+    const float32x4_t centerX = vdupq_n_f32(ripple.centerX);
+    const float32x4_t centerZ = vdupq_n_f32(ripple.centerZ);
+    const float32x4_t amplitude = vdupq_n_f32(ripple.amplitude);
+    const float32x4_t phaseScale = vdupq_n_f32(ripple.phaseScale);
+    const float32x4_t waveTime = vdupq_n_f32(ripple.waveTime);
+
+    size_t index = 0;
+    for (; index + 4 <= count; index += 4) {
+        float32x4_t dx = vsubq_f32(vld1q_f32(x + index), centerX);
+        float32x4_t dz = vsubq_f32(vld1q_f32(z + index), centerZ);
+        float32x4_t distance = vsqrtq_f32(vfmaq_f32(vmulq_f32(dz, dz), dx, dx));
+        float32x4_t phase = vfmaq_f32(waveTime, distance, phaseScale);
+
+        float32x4_t k = vrndnq_f32(vmulq_f32(phase, vdupq_n_f32(INV_TWO_PI)));
+        float32x4_t r = vfmsq_f32(vfmsq_f32(phase, k, vdupq_n_f32(TWO_PI_HI)), k, vdupq_n_f32(TWO_PI_LO));
+        r = vbslq_f32(vcgtq_f32(r, vdupq_n_f32(SIN_HALF_PI)), vsubq_f32(vdupq_n_f32(SIN_PI), r), r);
+        r = vbslq_f32(vcltq_f32(r, vdupq_n_f32(-SIN_HALF_PI)), vsubq_f32(vdupq_n_f32(-SIN_PI), r), r);
+
+        float32x4_t r2 = vmulq_f32(r, r);
+        float32x4_t p = vfmaq_f32(vdupq_n_f32(SIN_C9), r2, vdupq_n_f32(SIN_C11));
+        p = vfmaq_f32(vdupq_n_f32(SIN_C7), r2, p);
+        p = vfmaq_f32(vdupq_n_f32(SIN_C5), r2, p);
+        p = vfmaq_f32(vdupq_n_f32(SIN_C3), r2, p);
+        float32x4_t sine = vfmaq_f32(r, vmulq_f32(r, r2), p);
+
+        vst1q_f32(heights + index, vmulq_f32(amplitude, sine));
+    }
+
+    for (; index < count; ++index) {
+        heights[index] = ApproximateHeight(x[index], z[index], ripple);
+    }
+}
+#endif
+
+static DeformKernel GetKernelFunction(SimdKernel kernel)
+{
+    switch (kernel) {
+#if defined(RIPPLE_HAS_SSE2)
+        case SimdKernel::Sse2 :
+            return DeformSse2;
+#endif
+#if defined(RIPPLE_HAS_AVX2)
+        case SimdKernel::Avx2 :
+            return DeformAvx2;
+#endif
+#if defined(RIPPLE_HAS_NEON)
+        case SimdKernel::Neon :
+            return DeformNeon;
+#endif
+        default :
+            return DeformScalar;
+    }
+}
+
+CpuDeformer::CpuDeformer() :
+        _kernel(GetBestKernel())
+{ }
+
+CpuDeformer::~CpuDeformer()
+{ }
+
+void CpuDeformer::Init(int quadsX, int quadsZ, float sizeX, float sizeZ)
+{
+    const size_t vertexCount = static_cast<size_t>(quadsX + 1) * (quadsZ + 1);
+    const float halfSizeX = sizeX / 2.0f;
+    const float halfSizeZ = sizeZ / 2.0f;
+
+    _x.resize(vertexCount);
+    _z.resize(vertexCount);
+    _heights.assign(vertexCount, 0.0f);
+
+    size_t index = 0;
+    for (int j = 0; j <= quadsZ; ++j) {
+        for (int i = 0; i <= quadsX; ++i) {
+            _x[index] = ((static_cast<float>(i) / quadsX) * 2 - 1) * halfSizeX;
+            _z[index] = ((static_cast<float>(j) / quadsZ) * 2 - 1) * halfSizeZ;
+            ++index;
+        }
+    }
+}
+
+void CpuDeformer::Deform(const FrameUniforms& frameUniforms, ThreadPool* threadPool, glm::vec3* positions)
+{
+    Ripple ripple;
+    ripple.centerX = frameUniforms.waveCenter.x;
+    ripple.centerZ = frameUniforms.waveCenter.y;
+    ripple.amplitude = frameUniforms.amplitude;
+    ripple.phaseScale = -PI * frameUniforms.frequency;
+    ripple.waveTime = frameUniforms.waveTime;
+
+    const DeformKernel kernel = GetKernelFunction(_kernel);
+    const size_t vertexCount = _heights.size();
+    const size_t tileCount = (vertexCount + TILE_SIZE - 1) / TILE_SIZE;
+
+    const float* x = _x.data();
+    const float* z = _z.data();
+    float* heights = _heights.data();
+
+    // The task only holds a reference to runTile: a lambda with copies of all of these is too large for
+    // std::function's own storage, and building it would allocate on every frame.
+    auto runTile = [&](size_t tile) {
+        const size_t begin = tile * TILE_SIZE;
+        const size_t count = std::min(TILE_SIZE, vertexCount - begin);
+        kernel(x + begin, z + begin, heights + begin, count, ripple);
+
+        // Written strictly in order, which suits write-combined memory such as a mapped buffer.
+        if (positions) {
+            for (size_t index = begin; index < begin + count; ++index) {
+                positions[index] = glm::vec3(x[index], heights[index], z[index]);
+            }
+        }
+    };
+    std::function<void(size_t)> deformTile = [&runTile](size_t tile) { runTile(tile); };
+
+    if (threadPool) {
+        threadPool->ParallelFor(tileCount, deformTile);
+    }
+    else {
+        for (size_t tile = 0; tile < tileCount; ++tile) {
+            deformTile(tile);
+        }
+    }
+}
+
+SimdKernel CpuDeformer::GetKernel() const
+{
+    return _kernel;
+}
+
+bool CpuDeformer::SetKernel(SimdKernel kernel)
+{
+    if (!IsKernelSupported(kernel)) {
+        return false;
+    }
+    _kernel = kernel;
+    return true;
+}
+
+bool CpuDeformer::IsKernelSupported(SimdKernel kernel)
+{
+    switch (kernel) {
+        case SimdKernel::Scalar :
+            return true;
+#if defined(RIPPLE_HAS_SSE2)
+        case SimdKernel::Sse2 :
+            return true;
+#endif
+#if defined(RIPPLE_HAS_AVX2)
+        case SimdKernel::Avx2 :
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+#if defined(RIPPLE_HAS_NEON)
+        case SimdKernel::Neon :
+            return true;
+#endif
+        default :
+            return false;
+    }
+}
+
+SimdKernel CpuDeformer::GetBestKernel()
+{
+    const SimdKernel preferred[] = { SimdKernel::Avx2, SimdKernel::Neon, SimdKernel::Sse2 };
+    for (size_t index = 0; index < sizeof(preferred) / sizeof(preferred[0]); ++index) {
+        if (IsKernelSupported(preferred[index])) {
+            return preferred[index];
+        }
+    }
+    return SimdKernel::Scalar;
+}
+
+const char* CpuDeformer::GetKernelName(SimdKernel kernel)
+{
+    switch (kernel) {
+        case SimdKernel::Sse2 :
+            return "SSE2";
+        case SimdKernel::Avx2 :
+            return "AVX2";
+        case SimdKernel::Neon :
+            return "NEON";
+        default :
+            return "scalar";
+    }
+}
+
+size_t CpuDeformer::GetVertexCount() const
+{
+    return _heights.size();
+}
+
+const std::vector<float>& CpuDeformer::GetX() const
+{
+    return _x;
+}
+
+const std::vector<float>& CpuDeformer::GetZ() const
+{
+    return _z;
+}
+
+const std::vector<float>& CpuDeformer::GetHeights() const
+{
+    return _heights;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "FrameUniforms.h"
+
+class ThreadPool;
+
+// Instruction sets the CPU deformer has kernels for.
+enum class SimdKernel
+{
+    Scalar,
+    Sse2,
+    Avx2,   // with FMA; picked at runtime on x86 when the CPU supports it
+    Neon
+};
+
+/**
+ * CPU reference implementation of the ripple in Vertex.shader:
+ *
+ *     y = amplitude * sin(-PI * distance * frequency + waveTime)
+ *
+ * evaluated for every grid point, for validating GPU output and for running without a GPU. The grid
+ * is kept as a structure of arrays (x, z and the resulting heights) in GridMesh vertex order, so the
+ * SIMD kernels read and write whole registers at a time. A deformation is split into tiles that fit
+ * in the L2 cache and spread over a thread pool.
+ */
+class CpuDeformer final
+{
+public:
+    // Grid points per tile: three float arrays of this length take 192KB.
+    static const size_t TILE_SIZE = 16384;
+
+    CpuDeformer();
+
+    CpuDeformer(const CpuDeformer& rhs) = delete;
+    CpuDeformer(CpuDeformer&& rhs) = delete;
+
+    CpuDeformer& operator=(const CpuDeformer& rhs) = delete;
+    CpuDeformer& operator=(CpuDeformer&& rhs) = delete;
+
+    ~CpuDeformer();
+
+    // Lays out the undeformed grid; positions match the GridMesh ones for the same arguments.
+    void Init(int quadsX, int quadsZ, float sizeX, float sizeZ);
+
+    // Evaluates the ripple for the wave center, amplitude, frequency and time of the frame uniforms.
+    // Without a pool the calling thread does all the work. If positions is given, every tile is also
+    // written there as x, y, z vertices while it is still in cache, e.g. into a mapped vertex buffer.
+    void Deform(const FrameUniforms& frameUniforms, ThreadPool* threadPool, glm::vec3* positions = nullptr);
+
+    SimdKernel GetKernel() const;
+
+    // Returns false, keeping the current kernel, if this build or CPU can't run the given one.
+    bool SetKernel(SimdKernel kernel);
+
+    static bool IsKernelSupported(SimdKernel kernel);
+    static SimdKernel GetBestKernel();
+    static const char* GetKernelName(SimdKernel kernel);
+
+    size_t GetVertexCount() const;
+
+    const std::vector<float>& GetX() const;
+    const std::vector<float>& GetZ() const;
+    const std::vector<float>& GetHeights() const;
+
+private:
+    SimdKernel _kernel;
+
+    std::vector<float> _x;
+    std::vector<float> _z;
+    std::vector<float> _heights;
+};
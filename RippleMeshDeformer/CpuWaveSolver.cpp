@@ -0,0 +1,265 @@
+#include "CpuWaveSolver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "ThreadPool.h"
+
+// As in WaveSimulation.cpp and WaveStep.shader: waves travel half a grid point per step.
+static const float COURANT_SQUARED = 0.25f;
+static const float PI = 3.14159f;
+
+CpuWaveSolver::CpuWaveSolver() :
+        _columns(0),
+        _rows(0),
+        _spacing(0.0f, 0.0f),
+        _damping(0.0f),
+        _stepCount(0),
+        _gridTrafficBytes(0),
+        _computedPointCount(0)
+{ }
+
+CpuWaveSolver::~CpuWaveSolver()
+{ }
+
+void CpuWaveSolver::Init(int quadsX, int quadsZ, float sizeX, float sizeZ, int stepRate, float damping)
+{
+    _columns = quadsX + 1;
+    _rows = quadsZ + 1;
+    _spacing = glm::vec2(sizeX / quadsX, sizeZ / quadsZ);
+    _damping = std::min(damping / stepRate, 1.0f);
+
+    // The surface starts flat and at rest.
+    const size_t count = static_cast<size_t>(_columns) * _rows;
+    _heights.assign(count, 0.0f);
+    _previousHeights.assign(count, 0.0f);
+    _nextHeights.assign(count, 0.0f);
+    _nextPreviousHeights.assign(count, 0.0f);
+
+    _drops.clear();
+    _stepCount = 0;
+    _gridTrafficBytes = 0;
+    _computedPointCount = 0;
+}
+
+void CpuWaveSolver::AddDrop(const glm::vec2& position, float radius, float height)
+{
+    const glm::vec2 gridPoint = position / _spacing + glm::vec2(_columns - 1, _rows - 1) * 0.5f;
+    const float gridRadius = std::max(radius / std::min(_spacing.x, _spacing.y), 2.0f);
+    _drops.push_back(glm::vec4(gridPoint.x, gridPoint.y, gridRadius, height));
+}
+
+void CpuWaveSolver::Run(int steps, int timeBlock, ThreadPool* threadPool)
+{
+    timeBlock = std::max(1, std::min(timeBlock, MAX_TIME_BLOCK));
+
+    const int tilesX = (_columns + TILE_POINTS - 1) / TILE_POINTS;
+    const int tilesZ = (_rows + TILE_POINTS - 1) / TILE_POINTS;
+    const size_t tileCount = static_cast<size_t>(tilesX) * tilesZ;
+
+    // Each tile counts into its own slots, so the threads never share a counter.
+    std::vector<unsigned long long> trafficBytes(tileCount), computedPoints(tileCount);
+
+    while (steps > 0) {
+        const int block = std::min(timeBlock, steps);
+
+        // Drops apply to the first step of the block, as they would to the next step on the GPU.
+        std::vector<glm::vec4> drops;
+        drops.swap(_drops);
+
+        auto runTile = [&](size_t tile) {
+            RunTile(static_cast<int>(tile % tilesX), static_cast<int>(tile / tilesX), block, drops,
+                    trafficBytes[tile], computedPoints[tile]);
+        };
+        if (threadPool) {
+            threadPool->ParallelFor(tileCount, runTile);
+        }
+        else {
+            for (size_t tile = 0; tile < tileCount; ++tile) {
+                runTile(tile);
+            }
+        }
+
+        _heights.swap(_nextHeights);
+        _previousHeights.swap(_nextPreviousHeights);
+        _stepCount += static_cast<unsigned long long>(block);
+        steps -= block;
+    }
+
+    for (size_t tile = 0; tile < tileCount; ++tile) {
+        _gridTrafficBytes += trafficBytes[tile];
+        _computedPointCount += computedPoints[tile];
+    }
+}
+
+void CpuWaveSolver::RunTile(int tileX, int tileZ, int steps, const std::vector<glm::vec4>& drops,
+                            unsigned long long& trafficBytes, unsigned long long& computedPoints)
+{
+    // The tile's interior, and the buffer around it with a halo of one point per step.
+    const int interiorX = tileX * TILE_POINTS;
+    const int interiorZ = tileZ * TILE_POINTS;
+    const int interiorWidth = std::min(TILE_POINTS, _columns - interiorX);
+    const int interiorHeight = std::min(TILE_POINTS, _rows - interiorZ);
+    const int originX = interiorX - steps;
+    const int originZ = interiorZ - steps;
+    const int width = interiorWidth + 2 * steps;
+    const int height = interiorHeight + 2 * steps;
+
+    // Kept per thread across tiles and blocks, so the buffers are allocated once and stay in cache.
+    thread_local std::vector<float> current, previous, source;
+    current.resize(static_cast<size_t>(width) * height);
+    previous.resize(current.size());
+
+    // Load both time levels. Points past the grid edges are 0 and never stepped, which holds the edges
+    // at 0 as on the GPU.
+    const int loadBeginX = std::max(originX, 0);
+    const int loadEndX = std::min(originX + width, _columns);
+    for (int z = 0; z < height; ++z) {
+        float* currentRow = &current[static_cast<size_t>(z) * width];
+        float* previousRow = &previous[static_cast<size_t>(z) * width];
+        const int gridZ = originZ + z;
+        if (gridZ < 0 || gridZ >= _rows) {
+            std::fill(currentRow, currentRow + width, 0.0f);
+            std::fill(previousRow, previousRow + width, 0.0f);
+            continue;
+        }
+
+        const size_t gridOffset = static_cast<size_t>(gridZ) * _columns + loadBeginX;
+        const int begin = loadBeginX - originX;
+        const int end = loadEndX - originX;
+        std::fill(currentRow, currentRow + begin, 0.0f);
+        std::fill(previousRow, previousRow + begin, 0.0f);
+        std::memcpy(currentRow + begin, &_heights[gridOffset], (end - begin) * sizeof(float));
+        std::memcpy(previousRow + begin, &_previousHeights[gridOffset], (end - begin) * sizeof(float));
+        std::fill(currentRow + end, currentRow + width, 0.0f);
+        std::fill(previousRow + end, previousRow + width, 0.0f);
+        trafficBytes += 2ULL * (end - begin) * sizeof(float);
+    }
+
+    for (int step = 0; step < steps; ++step) {
+        // The first step reads the heights with the drops added, but keeps the plain ones as the
+        // previous heights of the second, as WaveStep.shader does.
+        const float* read = current.data();
+        if (step == 0 && !drops.empty()) {
+            source = current;
+            for (size_t index = 0; index < drops.size(); ++index) {
+                const glm::vec4& drop = drops[index];
+                const int beginZ = std::max(static_cast<int>(std::floor(drop.y - drop.z)) - originZ, 0);
+                const int endZ = std::min(static_cast<int>(std::ceil(drop.y + drop.z)) + 1 - originZ, height);
+                const int beginX = std::max(static_cast<int>(std::floor(drop.x - drop.z)) - originX, 0);
+                const int endX = std::min(static_cast<int>(std::ceil(drop.x + drop.z)) + 1 - originX, width);
+                for (int z = beginZ; z < endZ; ++z) {
+                    for (int x = beginX; x < endX; ++x) {
+                        const int gridX = originX + x;
+                        const int gridZ = originZ + z;
+                        const float dx = gridX - drop.x;
+                        const float dz = gridZ - drop.y;
+                        const float distance = std::sqrt(dx * dx + dz * dz);
+                        if (distance < drop.z && gridX >= 0 && gridX < _columns && gridZ >= 0 && gridZ < _rows) {
+                            source[static_cast<size_t>(z) * width + x] += drop.w * 0.5f * (std::cos(PI * distance / drop.z) + 1.0f);
+                        }
+                    }
+                }
+            }
+            read = source.data();
+        }
+
+        // Points whose neighbors are still up to date: one ring fewer per step, and only inside the grid.
+        const int ring = step + 1;
+        const int beginX = std::max(ring, -originX);
+        const int endX = std::min(width - ring, _columns - originX);
+        const int beginZ = std::max(ring, -originZ);
+        const int endZ = std::min(height - ring, _rows - originZ);
+
+        // The next heights overwrite the previous ones in place, each point only reading its own.
+        const float keep = 1.0f - _damping;
+        for (int z = beginZ; z < endZ; ++z) {
+            const float* row = read + static_cast<size_t>(z) * width;
+            float* previousRow = &previous[static_cast<size_t>(z) * width];
+            for (int x = beginX; x < endX; ++x) {
+                const float h = row[x];
+                const float laplacian = row[x - 1] + row[x + 1] + row[x - width] + row[x + width] - 4.0f * h;
+                previousRow[x] = h + (h - previousRow[x]) * keep + COURANT_SQUARED * laplacian;
+            }
+        }
+        if (endX > beginX && endZ > beginZ) {
+            computedPoints += static_cast<unsigned long long>(endX - beginX) * (endZ - beginZ);
+        }
+
+        current.swap(previous);
+    }
+
+    // Write the interior's two time levels back to the next grid.
+    for (int z = 0; z < interiorHeight; ++z) {
+        const size_t local = static_cast<size_t>(z + steps) * width + steps;
+        const size_t gridOffset = static_cast<size_t>(interiorZ + z) * _columns + interiorX;
+        std::memcpy(&_nextHeights[gridOffset], &current[local], interiorWidth * sizeof(float));
+        std::memcpy(&_nextPreviousHeights[gridOffset], &previous[local], interiorWidth * sizeof(float));
+    }
+    trafficBytes += 2ULL * interiorWidth * interiorHeight * sizeof(float);
+}
+
+int CpuWaveSolver::GetColumns() const
+{
+    return _columns;
+}
+
+int CpuWaveSolver::GetRows() const
+{
+    return _rows;
+}
+
+const std::vector<float>& CpuWaveSolver::GetHeights() const
+{
+    return _heights;
+}
+
+unsigned long long CpuWaveSolver::GetStepCount() const
+{
+    return _stepCount;
+}
+
+unsigned long long CpuWaveSolver::GetGridTrafficBytes() const
+{
+    return _gridTrafficBytes;
+}
+
+unsigned long long CpuWaveSolver::GetComputedPointCount() const
+{
+    return _computedPointCount;
+}
+
+double CpuWaveSolver::MeasureCopyBandwidth(ThreadPool* threadPool)
+{
+    // 64MB per buffer, well past the last level cache, copied in 1MB chunks; the best of a few runs.
+    const size_t count = 16 * 1024 * 1024;
+    const size_t chunkSize = 256 * 1024;
+    const size_t chunkCount = count / chunkSize;
+    std::vector<float> from(count, 1.0f), to(count, 0.0f);
+
+    auto copyChunk = [&](size_t chunk) {
+        std::memcpy(&to[chunk * chunkSize], &from[chunk * chunkSize], chunkSize * sizeof(float));
+    };
+
+    double bestSeconds = 0.0;
+    for (int run = 0; run < 5; ++run) {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (threadPool) {
+            threadPool->ParallelFor(chunkCount, copyChunk);
+        }
+        else {
+            for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+                copyChunk(chunk);
+            }
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (run == 0 || seconds < bestSeconds) {
+            bestSeconds = seconds;
+        }
+    }
+
+    // Every byte is read once and written once.
+    return 2.0 * count * sizeof(float) / bestSeconds;
+}
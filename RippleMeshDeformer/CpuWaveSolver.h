@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// GLM: OpenGL Math
+#include <glm/glm.hpp>
+
+class ThreadPool;
+
+/**
+ * CPU implementation of the damped wave equation of WaveSimulation and WaveStep.shader, for baking
+ * ripple animations without a GPU. Same grid, same drops, same update:
+ *
+ *     next = current + (current - previous) * (1 - damping) + courantSquared * laplacian(current)
+ *
+ * A naive solver streams both time levels through memory on every step, so it is bandwidth-bound on
+ * any grid larger than the caches. Run() blocks the stencil in space and time instead: each tile of
+ * TILE_POINTS x TILE_POINTS grid points is loaded with a halo as wide as the steps of a time block,
+ * stepped that many times in a thread-local buffer that stays in the L2 cache, and only its interior
+ * is written back. Points near the halo's outer edge go stale one more row per step, but never reach
+ * the interior, so the result is bit-identical to stepping the whole grid one step at a time. The
+ * halos cost some recomputation, and in exchange the grid crosses memory once per block rather than
+ * once per step. Tiles are independent within a block, so they spread over a ThreadPool without any
+ * synchronization until the block ends.
+ */
+class CpuWaveSolver final
+{
+public:
+    // Grid points along a tile side; a tile of 128 + 2 * 8 points makes three float buffers of 250KB.
+    static const int TILE_POINTS = 128;
+
+    // Longest time block, which bounds the halo width.
+    static const int MAX_TIME_BLOCK = 8;
+
+    CpuWaveSolver();
+
+    CpuWaveSolver(const CpuWaveSolver& rhs) = delete;
+    CpuWaveSolver(CpuWaveSolver&& rhs) = delete;
+
+    CpuWaveSolver& operator=(const CpuWaveSolver& rhs) = delete;
+    CpuWaveSolver& operator=(CpuWaveSolver&& rhs) = delete;
+
+    ~CpuWaveSolver();
+
+    // A flat surface of (quadsX + 1) x (quadsZ + 1) points on a sizeX x sizeZ plane, stepped stepRate
+    // times per second; as WaveSimulation::Init.
+    void Init(int quadsX, int quadsZ, float sizeX, float sizeZ, int stepRate, float damping);
+
+    // Pushes the surface around a point of the plane, in world x/z, at the next step; as WaveSimulation.
+    void AddDrop(const glm::vec2& position, float radius, float height);
+
+    // Runs steps, timeBlock (1 to MAX_TIME_BLOCK) at a time per tile. Without a pool the calling thread
+    // does all the work.
+    void Run(int steps, int timeBlock, ThreadPool* threadPool);
+
+    int GetColumns() const;
+    int GetRows() const;
+
+    // The latest heights, one per grid point in GridMesh vertex order.
+    const std::vector<float>& GetHeights() const;
+
+    unsigned long long GetStepCount() const;
+
+    // Bytes Run() moved between the grid and the tile buffers so far, the traffic the blocking leaves
+    // for main memory; and the grid point updates it computed, including the halos' recomputed ones.
+    unsigned long long GetGridTrafficBytes() const;
+    unsigned long long GetComputedPointCount() const;
+
+    // Bytes per second of a parallel copy between buffers well beyond the caches, the practical peak the
+    // solver's traffic can be compared with.
+    static double MeasureCopyBandwidth(ThreadPool* threadPool);
+
+private:
+    // Runs a time block of steps for one tile; adds the bytes it moved to and from the grid, and the
+    // grid point updates it computed, to the counts.
+    void RunTile(int tileX, int tileZ, int steps, const std::vector<glm::vec4>& drops,
+                 unsigned long long& trafficBytes, unsigned long long& computedPoints);
+
+    int _columns;
+    int _rows;
+    glm::vec2 _spacing;
+    float _damping;     // per step
+
+    // The two time levels the next block reads, and the two it writes; swapped after every block.
+    std::vector<float> _heights;
+    std::vector<float> _previousHeights;
+    std::vector<float> _nextHeights;
+    std::vector<float> _nextPreviousHeights;
+
+    // Drops for the next step: grid point x/z, radius in grid points, height.
+    std::vector<glm::vec4> _drops;
+
+    unsigned long long _stepCount;
+    unsigned long long _gridTrafficBytes;
+    unsigned long long _computedPointCount;
+};
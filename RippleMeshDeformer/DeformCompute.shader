@@ -0,0 +1,75 @@
+#version 430 core
+
+// Deforms the grid once per frame, writing a position and a normal for every grid point. The grid
+// point (i, j) is stored at j * (gridQuads.x + 1) + i, the same order as the GridMesh vertices, so
+// the GridMesh index buffer can draw the result directly.
+
+layout (local_size_x = 16, local_size_y = 16) in;     // ComputeDeformer::WORK_GROUP_SIZE
+
+layout (std140) uniform FrameUniforms  // filled from the FrameUniforms struct in FrameUniforms.h
+{
+    mat4 modelViewProjectMatrix;
+    vec4 newColor;
+    vec2 waveCenter;
+    float waveTime;
+    float amplitude;
+    float frequency;
+};
+
+struct DeformedVertex
+{
+    vec4 position;
+    vec4 normal;
+};
+
+layout (std430, binding = 3) writeonly buffer DeformedVertices    // DEFORMED_VERTICES_BINDING
+{
+    DeformedVertex deformedVertices[];
+};
+
+uniform ivec2 gridQuads;    // number of quads along x and z
+uniform vec2 gridSize;      // size of the plane in world space
+
+const float PI = 3.14159;
+
+// Heights of the work group's grid points plus a one point apron, for the finite differences.
+shared float heights[18][18];
+
+vec2 GridPosition(ivec2 gridPoint)
+{
+    return (vec2(gridPoint) / vec2(gridQuads) * 2 - 1) * gridSize * 0.5;
+}
+
+float Height(vec2 position)
+{
+    float distance = length(position - waveCenter);
+    return amplitude * sin(-PI * distance * frequency + waveTime);
+}
+
+void main()
+{
+    // Evaluate the ripple once per point of the group and its apron; 18 x 18 points over 256 invocations.
+    ivec2 apronOrigin = ivec2(gl_WorkGroupID.xy) * 16 - 1;
+    for (uint cell = gl_LocalInvocationIndex; cell < 18u * 18u; cell += 256u) {
+        ivec2 local = ivec2(cell % 18u, cell / 18u);
+        heights[local.y][local.x] = Height(GridPosition(apronOrigin + local));
+    }
+
+    barrier();
+
+    ivec2 gridPoint = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThan(gridPoint, gridQuads))) {
+        return;
+    }
+
+    // Central differences over the neighbouring grid points.
+    ivec2 local = ivec2(gl_LocalInvocationID.xy) + 1;
+    vec2 spacing = gridSize / vec2(gridQuads);
+    float dydx = (heights[local.y][local.x + 1] - heights[local.y][local.x - 1]) / (2 * spacing.x);
+    float dydz = (heights[local.y + 1][local.x] - heights[local.y - 1][local.x]) / (2 * spacing.y);
+
+    vec2 position = GridPosition(gridPoint);
+    deformedVertices[gridPoint.y * (gridQuads.x + 1) + gridPoint.x] = DeformedVertex(
+            vec4(position.x, heights[local.y][local.x], position.y, 1),
+            vec4(normalize(vec3(-dydx, 1, -dydz)), 0));
+}
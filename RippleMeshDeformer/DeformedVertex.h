@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+// GLM: OpenGL Math
+#include <glm/glm.hpp>
+
+// Attribute locations of a deformed vertex buffer when it is drawn from, as in DeformedVertex.shader.
+const unsigned int DEFORMED_POSITION_LOCATION = 0;
+const unsigned int DEFORMED_NORMAL_LOCATION = 1;
+
+/**
+ * One grid point after deformation, as written by the compute and transform feedback deformers:
+ * the std430 DeformedVertex struct of DeformCompute.shader, or the interleaved deformedPosition and
+ * deformedNormal varyings of CaptureVertex.shader. The points are in GridMesh vertex order.
+ */
+struct DeformedVertex
+{
+    glm::vec4 position;
+    glm::vec4 normal;
+};
+
+// Sets up the attribute pointers of the bound VAO to read deformed vertices from a buffer.
+inline void SetDeformedVertexAttributes(GLuint bufferId)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, bufferId);
+
+    glVertexAttribPointer(DEFORMED_POSITION_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(DeformedVertex),
+                          reinterpret_cast<GLvoid*>(offsetof(DeformedVertex, position)));
+    glEnableVertexAttribArray(DEFORMED_POSITION_LOCATION);
+
+    glVertexAttribPointer(DEFORMED_NORMAL_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(DeformedVertex),
+                          reinterpret_cast<GLvoid*>(offsetof(DeformedVertex, normal)));
+    glEnableVertexAttribArray(DEFORMED_NORMAL_LOCATION);
+}
@@ -0,0 +1,25 @@
+#version 330 core
+
+// Draws vertices that were already deformed, by DeformCompute.shader, CaptureVertex.shader or the CPU
+// deformer; no ripple evaluation here.
+
+layout (location = 0) in vec4 position;  // DEFORMED_POSITION_LOCATION
+layout (location = 1) in vec4 normal;    // DEFORMED_NORMAL_LOCATION
+
+layout (std140) uniform FrameUniforms  // filled from the FrameUniforms struct in FrameUniforms.h
+{
+    mat4 modelViewProjectMatrix;
+    vec4 newColor;
+    vec2 waveCenter;
+    float waveTime;
+    float amplitude;
+    float frequency;
+};
+
+out vec3 vertexNormal;
+
+void main()
+{
+    vertexNormal = normal.xyz;
+    gl_Position = modelViewProjectMatrix * position;
+}
@@ -0,0 +1,86 @@
+#version 430 core
+
+// Sums any number of ripple emitters read from shader storage buffers, instead of the single ripple
+// around waveCenter in Vertex.shader. The emitters are uploaded by RippleEmitters.
+//
+// Variants, selected with #defines (see ShaderVariants):
+//   USE_TILES     1 (the default) sums only the emitters reaching the vertex's tile, 0 every emitter
+//   NUM_EMITTERS  the emitter count, known when the program is built; without it the untiled sum
+//                 loops to emitters.length()
+
+#ifndef USE_TILES
+#define USE_TILES 1
+#endif
+
+layout (location = 0) in vec3 vertex;    // use location so we don't need to call glBindAttribLocation(...)
+
+layout (std140) uniform FrameUniforms  // filled from the FrameUniforms struct in FrameUniforms.h
+{
+    mat4 modelViewProjectMatrix;
+    vec4 newColor;
+    vec2 waveCenter;
+    float waveTime;
+    float amplitude;
+    float frequency;
+};
+
+struct Emitter  // matches RippleEmitter in RippleEmitters.h
+{
+    vec2 center;
+    float amplitude;
+    float frequency;
+    float phase;
+    float decay;
+    float radius;
+    float padding;
+};
+
+layout (std430, binding = 0) readonly buffer Emitters
+{
+    Emitter emitters[];
+};
+
+layout (std430, binding = 1) readonly buffer EmitterTiles
+{
+    uvec2 tiles[];              // offset and count of each tile's range in tileIndices
+};
+
+layout (std430, binding = 2) readonly buffer EmitterTileIndices
+{
+    uint tileIndices[];
+};
+
+uniform ivec2 tileCount;
+uniform vec2 gridSize;
+
+const float PI = 3.14159;
+
+float EmitterHeight(Emitter emitter, vec2 position)
+{
+    float distance = length(position - emitter.center);
+    return emitter.amplitude * exp(-emitter.decay * distance)
+           * sin(-PI * distance * emitter.frequency + waveTime + emitter.phase);
+}
+
+void main()
+{
+    float y = 0;
+
+#if USE_TILES
+    ivec2 tile = clamp(ivec2(floor((vertex.xz / gridSize + 0.5) * vec2(tileCount))), ivec2(0), tileCount - 1);
+    uvec2 range = tiles[tile.y * tileCount.x + tile.x];
+    for (uint index = range.x; index < range.x + range.y; ++index) {
+        y += EmitterHeight(emitters[tileIndices[index]], vertex.xz);
+    }
+#else
+#ifdef NUM_EMITTERS
+    for (int index = 0; index < NUM_EMITTERS; ++index) {
+#else
+    for (int index = 0; index < emitters.length(); ++index) {
+#endif
+        y += EmitterHeight(emitters[index], vertex.xz);
+    }
+#endif
+
+    gl_Position = modelViewProjectMatrix * vec4(vertex.x, y, vertex.z, 1);
+}
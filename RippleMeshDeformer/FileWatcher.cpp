@@ -0,0 +1,70 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+
+#include <sys/stat.h>
+
+FileWatcher::FileWatcher()
+{ }
+
+FileWatcher::~FileWatcher()
+{ }
+
+void FileWatcher::AddFile(const std::string& path)
+{
+    if (std::find(_paths.begin(), _paths.end(), path) != _paths.end()) {
+        return;
+    }
+
+    FileStamp stamp = { 0, 0, 0 };
+    GetFileStamp(path, stamp);
+    _paths.push_back(path);
+    _stamps.push_back(stamp);
+}
+
+void FileWatcher::Clear()
+{
+    _paths.clear();
+    _stamps.clear();
+}
+
+bool FileWatcher::Poll()
+{
+    bool hasChanged = false;
+    for (size_t index = 0; index < _paths.size(); ++index) {
+        FileStamp stamp;
+        if (GetFileStamp(_paths[index], stamp) && stamp != _stamps[index]) {
+            _stamps[index] = stamp;
+            hasChanged = true;
+        }
+    }
+    return hasChanged;
+}
+
+const std::vector<std::string>& FileWatcher::GetPaths() const
+{
+    return _paths;
+}
+
+bool FileWatcher::FileStamp::operator!=(const FileStamp& rhs) const
+{
+    return seconds != rhs.seconds || nanoseconds != rhs.nanoseconds || bytes != rhs.bytes;
+}
+
+bool FileWatcher::GetFileStamp(const std::string& path, FileStamp& stamp)
+{
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0) {
+        return false;
+    }
+    stamp.seconds = static_cast<long long>(status.st_mtime);
+#if defined(__APPLE__)
+    stamp.nanoseconds = static_cast<long long>(status.st_mtimespec.tv_nsec);
+#elif defined(_WIN32)
+    stamp.nanoseconds = 0;
+#else
+    stamp.nanoseconds = static_cast<long long>(status.st_mtim.tv_nsec);
+#endif
+    stamp.bytes = static_cast<long long>(status.st_size);
+    return true;
+}
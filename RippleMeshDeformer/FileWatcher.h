@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * Notices changes to a set of files by polling their modification times and sizes.
+ *
+ * Times are compared to the nanosecond where the platform keeps them, so two saves within a second
+ * are both seen; the size catches the rest on file systems with coarser times. A file that can't be
+ * read, e.g. while an editor replaces it, keeps its last known stamp, so a save is only seen once the
+ * new file is in place. Polling is a stat() per file, cheap enough to do from the
+ * render loop every few frames.
+ */
+class FileWatcher final
+{
+public:
+    FileWatcher();
+
+    FileWatcher(const FileWatcher& rhs) = delete;
+    FileWatcher(FileWatcher&& rhs) = delete;
+
+    FileWatcher& operator=(const FileWatcher& rhs) = delete;
+    FileWatcher& operator=(FileWatcher&& rhs) = delete;
+
+    ~FileWatcher();
+
+    // Watches a file from its current modification time on; adding a file twice watches it once.
+    void AddFile(const std::string& path);
+
+    void Clear();
+
+    // Returns true if any file was modified since the last call (or since it was added).
+    bool Poll();
+
+    const std::vector<std::string>& GetPaths() const;
+
+private:
+    // What a file's last save is recognized by.
+    struct FileStamp
+    {
+        long long seconds;
+        long long nanoseconds;
+        long long bytes;
+
+        bool operator!=(const FileStamp& rhs) const;
+    };
+
+    static bool GetFileStamp(const std::string& path, FileStamp& stamp);
+
+    std::vector<std::string> _paths;
+    std::vector<FileStamp> _stamps;
+};
@@ -1,10 +1,92 @@
 #version 330 core
 
+// Variants, selected with #defines (see ShaderVariants):
+//   USE_LIGHTING  1 shades newColor with a directional light, using the vertexNormal of the vertex
+//                 shader; 0 (the default) outputs newColor as is
+//   USE_FAR_FIELD 1 adds the share of the ripple the vertex shader faded out back to the normal, per
+//                 pixel, from the same USE_DAMPING, DAMPING and WAVE_* settings as Vertex.shader
+
+#ifndef USE_LIGHTING
+#define USE_LIGHTING 0
+#endif
+#ifndef USE_FAR_FIELD
+#define USE_FAR_FIELD 0
+#endif
+#ifndef USE_DAMPING
+#define USE_DAMPING 0
+#endif
+#ifndef DAMPING
+#define DAMPING 1.0
+#endif
+
 layout (location = 0) out vec4 fragmentColor;  // use location so we don't need to call glBindAttribLocation(...)
 
-uniform vec4 newColor;
+layout (std140) uniform FrameUniforms  // filled from the FrameUniforms struct in FrameUniforms.h
+{
+    mat4 modelViewProjectMatrix;
+    vec4 newColor;
+    vec2 waveCenter;
+    float waveTime;
+    float amplitude;
+    float frequency;
+};
+
+#if USE_LIGHTING
+in vec3 vertexNormal;
+
+const vec3 LIGHT_DIRECTION = normalize(vec3(0.4, 1.0, 0.3));   // towards the light, in world space
+const float AMBIENT = 0.2;
+#endif
+
+#if USE_FAR_FIELD
+in vec2 surfacePosition;
+in float farFieldWeight;
+
+#ifdef WAVE_AMPLITUDE
+const float waveAmplitude = WAVE_AMPLITUDE;
+#else
+#define waveAmplitude amplitude
+#endif
+#ifdef WAVE_FREQUENCY
+const float waveFrequency = WAVE_FREQUENCY;
+#else
+#define waveFrequency frequency
+#endif
+
+const float PI = 3.14159;
+
+// Gradient of the ripple's height at a point of the plane, as in Vertex.shader.
+vec2 GetRippleGradient(vec2 position)
+{
+    vec2 offset = position - waveCenter;
+    float distance = length(offset);
+    float phase = -PI * distance * waveFrequency + waveTime;
+    float slope = -waveAmplitude * PI * waveFrequency * cos(phase);
+#if USE_DAMPING
+    slope = (slope - DAMPING * waveAmplitude * sin(phase)) * exp(-DAMPING * distance);
+#endif
+    return distance > 0 ? slope * offset / distance : vec2(0);
+}
+#endif
 
 void main()
 {
+#if USE_LIGHTING
+    // Lit from both sides, since the camera can look at the surface from underneath.
+    vec3 normal = normalize(vertexNormal);
+#if USE_FAR_FIELD
+    // The geometry only carries 1 - farFieldWeight of the ripple; add the rest of its gradient. A
+    // wavelength (2 / frequency) narrower than about two pixels would only shimmer, so it fades out.
+    float footprint = length(fwidth(surfacePosition)) * waveFrequency;
+    float weight = farFieldWeight * (1 - smoothstep(0.5, 1.0, footprint));
+    if (weight > 0) {
+        vec2 gradient = -normal.xz / normal.y + weight * GetRippleGradient(surfacePosition);
+        normal = normalize(vec3(-gradient.x, 1, -gradient.y));
+    }
+#endif
+    float diffuse = abs(dot(normal, LIGHT_DIRECTION));
+    fragmentColor = vec4(newColor.rgb * (AMBIENT + (1 - AMBIENT) * diffuse), newColor.a);
+#else
     fragmentColor = newColor;
+#endif
 }
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+// GLM: OpenGL Math
+#include <glm/glm.hpp>
+
+#include "FrameUniforms.h"
+
+/**
+ * Everything the simulation produces for a frame, for Render() to draw.
+ *
+ * With an update thread, states are produced at a fixed rate and handed to the render thread through
+ * a TripleBuffer; otherwise Render() produces one for itself at the start of every frame. The
+ * projection isn't part of it: it belongs to the window, so Render() applies it to the view.
+ */
+struct FrameState
+{
+    // The ripple parameters; modelViewProjectMatrix is left to Render().
+    FrameUniforms uniforms;
+
+    glm::mat4 modelViewMatrix;
+    glm::vec3 cameraPosition;   // in world space, for the level of detail of --mesh patches
+
+    double time;                // simulation time, in seconds
+    unsigned long long step;    // updates since the start; unchanged if Render() draws a state again
+
+    // DeformPath::Cpu with an update thread: the deformed grid, copied into the streamed vertex buffer.
+    std::vector<glm::vec3> positions;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+// GLM: OpenGL Math
+#include <glm/glm.hpp>
+
+// Uniform buffer binding point shared by every program that declares the FrameUniforms block.
+const unsigned int FRAME_UNIFORMS_BINDING = 0;
+
+/**
+ * Per-frame ripple parameters, laid out to match the std140 FrameUniforms block in the shaders:
+ *
+ *     layout (std140) uniform FrameUniforms
+ *     {
+ *         mat4 modelViewProjectMatrix;
+ *         vec4 newColor;
+ *         vec2 waveCenter;
+ *         float waveTime;
+ *         float amplitude;
+ *         float frequency;
+ *     };
+ *
+ * Keep the two in sync; the offsets in the comments are the std140 ones.
+ */
+struct FrameUniforms
+{
+    glm::mat4 modelViewProjectMatrix;   // offset 0
+    glm::vec4 newColor;                 // offset 64
+    glm::vec2 waveCenter;               // offset 80
+    float waveTime;                     // offset 88
+    float amplitude;                    // offset 92
+    float frequency;                    // offset 96
+    float padding[3];                   // round the block up to a multiple of 16 bytes
+};
+
+static_assert(sizeof(FrameUniforms) == 112, "FrameUniforms must match the std140 layout of the shader block");
@@ -1,15 +1,36 @@
 #include "GLSLProgram.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 
+#include "Arena.h"
+#include "ProgramBinaryCache.h"
+
+ProgramBinaryCache* GLSLProgram::_binaryCache = nullptr;
+
+// Info logs and active names, rewound after every use. One for each thread that builds programs, since
+// every context can, and once it holds the longest log, building one more doesn't touch the heap for them.
+static thread_local Arena scratchArena(4096);
+
+void GLSLProgram::SetBinaryCache(ProgramBinaryCache* binaryCache)
+{
+    _binaryCache = binaryCache;
+}
+
 GLSLProgram::GLSLProgram() :
         _shaderProgramHandle(0),
         _didLink(GL_FALSE),
         _vertexShader(0),
         _fragmentShader(0),
-        _geometryShader(0)
+        _geometryShader(0),
+        _tessControlShader(0),
+        _tessEvaluationShader(0),
+        _computeShader(0),
+        _transformFeedbackBufferMode(GL_INTERLEAVED_ATTRIBS),
+        _defersCompilation(false),
+        _isLinkPending(false)
 { }
 
 GLSLProgram::~GLSLProgram()
@@ -17,8 +38,23 @@ GLSLProgram::~GLSLProgram()
     DeleteProgram();
 }
 
-// Build and compile a shader
+// Build and compile a shader, or keep its source for CreateAndLinkProgram when compilation is deferred
 void GLSLProgram::AddShader(GLenum shaderType, const GLchar* const source)
+{
+    if (_defersCompilation || (_binaryCache != nullptr && _binaryCache->IsEnabled())) {
+        _pendingSources.push_back(std::make_pair(shaderType, std::string(source)));
+        return;
+    }
+    CompileShader(shaderType, source, true);
+}
+
+void GLSLProgram::SetDeferredCompilation(bool defersCompilation)
+{
+    _defersCompilation = defersCompilation;
+}
+
+// Without waiting for the status, the shader is kept even if it fails; FinishLink reports the error.
+void GLSLProgram::CompileShader(GLenum shaderType, const GLchar* const source, bool waitForStatus)
 {
     GLuint shader = glCreateShader(shaderType); // creates an empty shader object
     glShaderSource(shader,      // shader to be compiled
@@ -28,31 +64,55 @@ void GLSLProgram::AddShader(GLenum shaderType, const GLchar* const source)
 
     glCompileShader(shader);
 
-    GLint didCompile = 0;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &didCompile);
-    if (didCompile == GL_TRUE) {
-        switch (shaderType) {
-            case GL_VERTEX_SHADER :
-                _vertexShader = shader;
-                break;
-            case GL_FRAGMENT_SHADER :
-                _fragmentShader = shader;
-                break;
-            case GL_GEOMETRY_SHADER :
-                _geometryShader = shader;
+    if (!waitForStatus || CheckCompileStatus(shader)) {
+        GLuint* slot = GetShaderSlot(shaderType);
+        if (slot != nullptr) {
+            *slot = shader;
         }
     }
     else  {
+        glDeleteShader(shader); // don't leak the shader
+    }
+}
+
+// Returns true if the shader compiled, and prints its log otherwise.
+bool GLSLProgram::CheckCompileStatus(GLuint shader) const
+{
+    GLint didCompile = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &didCompile);
+    if (didCompile != GL_TRUE) {
         GLint logLength = 0;    // this will include the NULL character
         glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
 
-        GLchar* logBuffer = new GLchar[logLength];
+        const Arena::Marker marker = scratchArena.GetMarker();
+        GLchar* logBuffer = scratchArena.AllocateArray<GLchar>(std::max(logLength, 1));
+        logBuffer[0] = '\0';
         glGetShaderInfoLog(shader, logLength, nullptr, logBuffer);
 
         std::cerr << "GLSLProgram::AddShader compile error: " << logBuffer << std::endl;
 
-        delete[] logBuffer;     // don't leak the log buffer
-        glDeleteShader(shader); // don't leak the shader
+        scratchArena.Rewind(marker);
+    }
+    return didCompile == GL_TRUE;
+}
+
+GLuint* GLSLProgram::GetShaderSlot(GLenum shaderType)
+{
+    switch (shaderType) {
+        case GL_VERTEX_SHADER :
+            return &_vertexShader;
+        case GL_FRAGMENT_SHADER :
+            return &_fragmentShader;
+        case GL_GEOMETRY_SHADER :
+            return &_geometryShader;
+        case GL_TESS_CONTROL_SHADER :
+            return &_tessControlShader;
+        case GL_TESS_EVALUATION_SHADER :
+            return &_tessEvaluationShader;
+        case GL_COMPUTE_SHADER :
+            return &_computeShader;
+        default :
+            return nullptr;
     }
 }
 
@@ -65,6 +125,18 @@ void GLSLProgram::AddShader(GLenum shaderType, const std::string& source)
 
 // Build and compile a shader
 void GLSLProgram::AddShaderFromFile(GLenum shaderType, const std::string& filename)
+{
+    AddShaderFromFile(shaderType, filename, ShaderDefines());
+}
+
+// Build and compile a variant of a shader
+void GLSLProgram::AddShader(GLenum shaderType, const std::string& source, const ShaderDefines& defines)
+{
+    AddShader(shaderType, ApplyDefines(source, defines));
+}
+
+// Build and compile a variant of a shader
+void GLSLProgram::AddShaderFromFile(GLenum shaderType, const std::string& filename, const ShaderDefines& defines)
 {
     std::ifstream inputStream;
     inputStream.exceptions(std::ifstream::failbit | std::ifstream::badbit);
@@ -78,15 +150,75 @@ void GLSLProgram::AddShaderFromFile(GLenum shaderType, const std::string& filena
         inputStream.close();
 
         std::string shaderSourceAsString = shaderSource.str();
-        AddShader(shaderType, shaderSourceAsString);
+        AddShader(shaderType, shaderSourceAsString, defines);
     }
     catch(std::ios_base::failure& e) {
         std::cerr << "GLSLProgram::AddShaderFromFile: " << filename << " " << e.what() << " error code: " << e.code() << std::endl;
     }
 }
 
+std::string GLSLProgram::ApplyDefines(const std::string& source, const ShaderDefines& defines)
+{
+    if (defines.empty()) {
+        return source;
+    }
+
+    // #version has to come first, so the defines go right after its line.
+    size_t insertAt = 0;
+    int nextLine = 1;
+    const size_t version = source.find("#version");
+    if (version != std::string::npos) {
+        const size_t lineEnd = source.find('\n', version);
+        insertAt = lineEnd != std::string::npos ? lineEnd + 1 : source.size();
+        nextLine = 1 + static_cast<int>(std::count(source.begin(), source.begin() + insertAt, '\n'));
+    }
+
+    std::ostringstream block;
+    if (insertAt == source.size() && insertAt > 0 && source[insertAt - 1] != '\n') {
+        block << "\n";
+    }
+    for (ShaderDefines::const_iterator define = defines.begin(); define != defines.end(); ++define) {
+        block << "#define " << define->first << " " << define->second << "\n";
+    }
+    block << "#line " << nextLine << "\n";
+
+    return source.substr(0, insertAt) + block.str() + source.substr(insertAt);
+}
+
+void GLSLProgram::SetTransformFeedbackVaryings(const std::vector<std::string>& varyings, GLenum bufferMode)
+{
+    _transformFeedbackVaryings = varyings;
+    _transformFeedbackBufferMode = bufferMode;
+}
+
 GLuint GLSLProgram::CreateAndLinkProgram() {
+    CreateAndLinkProgramAsync();
+    return FinishLink();
+}
+
+void GLSLProgram::CreateAndLinkProgramAsync()
+{
     _shaderProgramHandle = glCreateProgram(); // create a shader program and return a reference to it
+    _didLink = GL_FALSE;
+
+    // A cached binary replaces compiling and linking; without one, start compiling the kept sources.
+    _cacheKey.clear();
+    if (!_pendingSources.empty()) {
+        if (_binaryCache != nullptr && _binaryCache->IsEnabled()) {
+            _cacheKey = _binaryCache->MakeKey(GetCacheSource());
+            if (_binaryCache->Load(_cacheKey, _shaderProgramHandle)) {
+                _pendingSources.clear();
+                _didLink = GL_TRUE;
+                return;
+            }
+            glProgramParameteri(_shaderProgramHandle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+
+        for (size_t index = 0; index < _pendingSources.size(); ++index) {
+            CompileShader(_pendingSources[index].first, _pendingSources[index].second.c_str(), false);
+        }
+        _pendingSources.clear();
+    }
 
     if (_vertexShader != 0) {
         glAttachShader(_shaderProgramHandle, _vertexShader);
@@ -97,25 +229,68 @@ GLuint GLSLProgram::CreateAndLinkProgram() {
     if (_geometryShader != 0) {
         glAttachShader(_shaderProgramHandle, _geometryShader);
     }
+    if (_tessControlShader != 0) {
+        glAttachShader(_shaderProgramHandle, _tessControlShader);
+    }
+    if (_tessEvaluationShader != 0) {
+        glAttachShader(_shaderProgramHandle, _tessEvaluationShader);
+    }
+    if (_computeShader != 0) {
+        glAttachShader(_shaderProgramHandle, _computeShader);
+    }
+
+    // The captured outputs are part of the link, so they have to be declared first.
+    if (!_transformFeedbackVaryings.empty()) {
+        std::vector<const GLchar*> varyings;
+        for (size_t index = 0; index < _transformFeedbackVaryings.size(); ++index) {
+            varyings.push_back(_transformFeedbackVaryings[index].c_str());
+        }
+        glTransformFeedbackVaryings(_shaderProgramHandle, static_cast<GLsizei>(varyings.size()), varyings.data(),
+                                    _transformFeedbackBufferMode);
+    }
 
     glLinkProgram(_shaderProgramHandle);
+    _isLinkPending = true;
+}
+
+GLuint GLSLProgram::FinishLink()
+{
+    if (!_isLinkPending) {
+        return _shaderProgramHandle;
+    }
+    _isLinkPending = false;
+
+    GLuint* shaders[] = { &_vertexShader, &_fragmentShader, &_geometryShader, &_tessControlShader,
+                          &_tessEvaluationShader, &_computeShader };
+    for (size_t index = 0; index < sizeof(shaders) / sizeof(shaders[0]); ++index) {
+        if (*shaders[index] != 0) {
+            CheckCompileStatus(*shaders[index]);
+        }
+    }
 
     glGetProgramiv(_shaderProgramHandle, GL_LINK_STATUS, &_didLink);
     if (_didLink != GL_TRUE) {
         GLint logLength = 0;    // this will include the NULL character
         glGetProgramiv(_shaderProgramHandle, GL_INFO_LOG_LENGTH, &logLength);
 
-        GLchar* logBuffer = new GLchar[logLength];
+        const Arena::Marker marker = scratchArena.GetMarker();
+        GLchar* logBuffer = scratchArena.AllocateArray<GLchar>(std::max(logLength, 1));
+        logBuffer[0] = '\0';
         glGetProgramInfoLog(_shaderProgramHandle, logLength, nullptr, logBuffer);
 
         std::cerr << "GLSLProgram::AddShader link error: " << logBuffer << std::endl;
 
-        delete[] logBuffer;
+        scratchArena.Rewind(marker);
+    }
+    else if (!_cacheKey.empty()) {
+        _binaryCache->Store(_cacheKey, _shaderProgramHandle);
     }
 
-    glDeleteShader(_vertexShader);
-    glDeleteShader(_fragmentShader);
-    glDeleteShader(_geometryShader);
+    // The program keeps what it needs; the shader objects can go, and a relink starts from new ones.
+    for (size_t index = 0; index < sizeof(shaders) / sizeof(shaders[0]); ++index) {
+        glDeleteShader(*shaders[index]);
+        *shaders[index] = 0;
+    }
 
     return _shaderProgramHandle;
 }
@@ -125,6 +300,11 @@ GLuint GLSLProgram::IsCreated() const
     return _didLink;
 }
 
+GLuint GLSLProgram::GetHandle() const
+{
+    return _shaderProgramHandle;
+}
+
 void GLSLProgram::UseProgram()
 {
     glUseProgram(_shaderProgramHandle);
@@ -147,7 +327,8 @@ GLint GLSLProgram::AddAttribute(const std::string& attribute)
 {
     GLint returnCode = -1;
     if (_didLink) {
-        returnCode = _attributeList[attribute] = glGetAttribLocation(_shaderProgramHandle, attribute.c_str());
+        returnCode = glGetAttribLocation(_shaderProgramHandle, attribute.c_str());
+        SetLocation(_attributeList, attribute, static_cast<GLuint>(returnCode));
     }
     return returnCode;
 }
@@ -162,7 +343,27 @@ GLint GLSLProgram::AddUniform(const std::string& uniform)
 {
     GLint returnCode = -1;
     if (_didLink) {
-        returnCode = _uniformList[uniform] = glGetUniformLocation(_shaderProgramHandle, uniform.c_str());
+        returnCode = glGetUniformLocation(_shaderProgramHandle, uniform.c_str());
+        SetLocation(_uniformList, uniform, static_cast<GLuint>(returnCode));
+    }
+    return returnCode;
+}
+
+// Connects a named uniform block to a uniform buffer binding point, so the block reads from whatever
+// buffer is bound there with glBindBufferBase.
+// If successful:
+// Returns the index of the block in the program.
+// If error:
+// Returns -1 if the program isn't linked or the block isn't an active uniform block in it.
+GLint GLSLProgram::BindUniformBlock(const std::string& block, GLuint bindingPoint)
+{
+    GLint returnCode = -1;
+    if (_didLink) {
+        GLuint blockIndex = glGetUniformBlockIndex(_shaderProgramHandle, block.c_str());
+        if (blockIndex != GL_INVALID_INDEX) {
+            glUniformBlockBinding(_shaderProgramHandle, blockIndex, bindingPoint);
+            returnCode = static_cast<GLint>(blockIndex);
+        }
     }
     return returnCode;
 }
@@ -170,35 +371,79 @@ GLint GLSLProgram::AddUniform(const std::string& uniform)
 GLuint GLSLProgram::GetAttributeLocation(const std::string& attribute) const
 {
     GLuint location = -1;
-    std::map<std::string, GLuint>::const_iterator iterator = _attributeList.find(attribute);
-    if (iterator != _attributeList.end()) {
-        location = iterator->second;
-    }
+    FindLocation(_attributeList, attribute, location);
     return location;
 }
 
 GLuint GLSLProgram::GetUniformLocation(const std::string& uniform) const
 {
     GLuint location = -1;
-    std::map<std::string, GLuint>::const_iterator iterator = _uniformList.find(uniform);
-    if (iterator != _uniformList.end()) {
-        location = iterator->second;
-    }
+    FindLocation(_uniformList, uniform, location);
     return location;
 }
 
+// Returns the location of a uniform added with AddUniform, asking the driver only for other names.
+GLint GLSLProgram::FindUniformLocation(const std::string& uniform) const
+{
+    GLuint location;
+    if (FindLocation(_uniformList, uniform, location)) {
+        return static_cast<GLint>(location);
+    }
+    return glGetUniformLocation(_shaderProgramHandle, uniform.c_str());
+}
+
+// Compares an entry's name with a name, for the binary searches of a LocationList.
+static bool IsNameBefore(const std::pair<std::string, GLuint>& entry, const std::string& name)
+{
+    return entry.first < name;
+}
+
+void GLSLProgram::SetLocation(LocationList& list, const std::string& name, GLuint location)
+{
+    LocationList::iterator iterator = std::lower_bound(list.begin(), list.end(), name, IsNameBefore);
+    if (iterator != list.end() && iterator->first == name) {
+        iterator->second = location;
+    }
+    else {
+        list.insert(iterator, std::make_pair(name, location));
+    }
+}
+
+bool GLSLProgram::FindLocation(const LocationList& list, const std::string& name, GLuint& location)
+{
+    LocationList::const_iterator iterator = std::lower_bound(list.begin(), list.end(), name, IsNameBefore);
+    if (iterator == list.end() || iterator->first != name) {
+        return false;
+    }
+    location = iterator->second;
+    return true;
+}
+
+std::string GLSLProgram::GetCacheSource() const
+{
+    std::ostringstream source;
+    for (size_t index = 0; index < _pendingSources.size(); ++index) {
+        source << "#stage " << _pendingSources[index].first << "\n" << _pendingSources[index].second << "\n";
+    }
+    for (size_t index = 0; index < _transformFeedbackVaryings.size(); ++index) {
+        source << "#varying " << _transformFeedbackVaryings[index] << " " << _transformFeedbackBufferMode << "\n";
+    }
+    return source.str();
+}
+
 std::string GLSLProgram::ToString() const
 {
     std::ostringstream programData;
     GLint maxBufferSize, nbrOfAttributes, nbrOfUniforms, charsInBuffer, size, location;
     GLchar* name;
     GLenum type;
+    const Arena::Marker marker = scratchArena.GetMarker();
 
     programData << "GLSL program handle: " << _shaderProgramHandle << "\n";
 
     glGetProgramiv(_shaderProgramHandle, GL_ACTIVE_ATTRIBUTES, &nbrOfAttributes);
     glGetProgramiv(_shaderProgramHandle, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxBufferSize);
-    name = new GLchar[maxBufferSize];
+    name = scratchArena.AllocateArray<GLchar>(std::max(maxBufferSize, 1));
 
     for (int index = 0; index < nbrOfAttributes; ++index) {
         glGetActiveAttrib(_shaderProgramHandle, index, maxBufferSize, &charsInBuffer, &size, &type, name);
@@ -207,11 +452,11 @@ std::string GLSLProgram::ToString() const
         programData << "Attribute name: " << name << " location: " << location << "\n";
     }
 
-    delete[] name;
+    scratchArena.Rewind(marker);
 
     glGetProgramiv(_shaderProgramHandle, GL_ACTIVE_UNIFORMS, &nbrOfUniforms);
     glGetProgramiv(_shaderProgramHandle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxBufferSize);
-    name = new GLchar[maxBufferSize];
+    name = scratchArena.AllocateArray<GLchar>(std::max(maxBufferSize, 1));
 
     for (int index = 0; index < nbrOfUniforms; ++index) {
         glGetActiveUniform(_shaderProgramHandle, index, maxBufferSize, &charsInBuffer, &size, &type, name);
@@ -220,7 +465,7 @@ std::string GLSLProgram::ToString() const
         programData << "Uniform name:   " << name << " location: " << location << "\n";
     }
 
-    delete[] name;
+    scratchArena.Rewind(marker);
 
     return programData.str();
 }
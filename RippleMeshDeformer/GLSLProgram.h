@@ -2,6 +2,8 @@
 
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 // GLEW: OpenGL Extension Wrangler
 #include <GL/glew.h>
@@ -9,9 +11,54 @@
 // GLM: OpenGL Math
 #include <glm/glm.hpp>
 
+class ProgramBinaryCache;
+
+// Preprocessor symbols a shader is specialized with, by name; a value may be empty. The map keeps them
+// sorted, so the same set always produces the same source.
+typedef std::map<std::string, std::string> ShaderDefines;
+
+/**
+ * A uniform location resolved once, after the program is linked.
+ *
+ * Setting a value through a handle goes straight to the matching glUniform* call: no name lookup, no
+ * temporary strings and no query to the driver. Like glUniform*, Set() applies to the program that is
+ * currently in use.
+ */
+template <typename T>
+class UniformHandle final
+{
+public:
+    UniformHandle() : _location(-1) { }
+    explicit UniformHandle(GLint location) : _location(location) { }
+
+    bool IsValid() const { return _location != -1; }
+
+    GLint GetLocation() const { return _location; }
+
+    void Set(const T& value) const;
+
+private:
+    GLint _location;
+};
+
+template <> inline void UniformHandle<bool>::Set(const bool& value) const { glUniform1i(_location, static_cast<int>(value)); }
+template <> inline void UniformHandle<int>::Set(const int& value) const { glUniform1i(_location, value); }
+template <> inline void UniformHandle<float>::Set(const float& value) const { glUniform1f(_location, value); }
+template <> inline void UniformHandle<glm::ivec2>::Set(const glm::ivec2& value) const { glUniform2iv(_location, 1, &value[0]); }
+template <> inline void UniformHandle<glm::vec2>::Set(const glm::vec2& value) const { glUniform2fv(_location, 1, &value[0]); }
+template <> inline void UniformHandle<glm::vec3>::Set(const glm::vec3& value) const { glUniform3fv(_location, 1, &value[0]); }
+template <> inline void UniformHandle<glm::vec4>::Set(const glm::vec4& value) const { glUniform4fv(_location, 1, &value[0]); }
+template <> inline void UniformHandle<glm::mat2>::Set(const glm::mat2& value) const { glUniformMatrix2fv(_location, 1, GL_FALSE, &value[0][0]); }
+template <> inline void UniformHandle<glm::mat3>::Set(const glm::mat3& value) const { glUniformMatrix3fv(_location, 1, GL_FALSE, &value[0][0]); }
+template <> inline void UniformHandle<glm::mat4>::Set(const glm::mat4& value) const { glUniformMatrix4fv(_location, 1, GL_FALSE, &value[0][0]); }
+
 class GLSLProgram final
 {
 public:
+    // With a cache, a program keeps the sources added afterwards until it is linked, and is restored
+    // from a cached binary instead when one matches them. Pass nullptr to compile every program again.
+    static void SetBinaryCache(ProgramBinaryCache* binaryCache);
+
     GLSLProgram();
 
     GLSLProgram(const GLSLProgram& rhs) = delete;
@@ -26,10 +73,35 @@ public:
     void AddShader(GLenum shaderType, const std::string &source);
     void AddShaderFromFile(GLenum shaderType, const std::string &filename);
 
+    // Variants of a shader: the defines are inserted after the #version line, so #if blocks on them are
+    // resolved by the compiler and constants fold as if they had been typed into the source.
+    void AddShader(GLenum shaderType, const std::string& source, const ShaderDefines& defines);
+    void AddShaderFromFile(GLenum shaderType, const std::string& filename, const ShaderDefines& defines);
+
+    // The source with a #define line for each symbol after its #version line, then a #line directive so
+    // compile errors still point at the lines of the file.
+    static std::string ApplyDefines(const std::string& source, const ShaderDefines& defines);
+
+    // Outputs to capture with transform feedback; must be set before CreateAndLinkProgram.
+    void SetTransformFeedbackVaryings(const std::vector<std::string>& varyings, GLenum bufferMode);
+
     GLuint CreateAndLinkProgram();
 
+    // Keep the sources of the shaders added from now on, and only compile them in CreateAndLinkProgram
+    // or CreateAndLinkProgramAsync, which can then overlap compiling with linking.
+    void SetDeferredCompilation(bool defersCompilation);
+
+    // CreateAndLinkProgram in two halves, so the driver gets every stage and the link before anything
+    // waits on it: the first issues the compile and link commands without asking for their status;
+    // FinishLink reads the status, prints any errors, and returns the program handle.
+    void CreateAndLinkProgramAsync();
+    GLuint FinishLink();
+
     GLuint IsCreated() const;
 
+    // The program object, which every context sharing objects with this one can use.
+    GLuint GetHandle() const;
+
     void UseProgram();
 
     void DeleteProgram();
@@ -37,73 +109,104 @@ public:
     GLint AddAttribute(const std::string& attribute);
     GLint AddUniform(const std::string& uniform);
 
+    // Connects a named uniform block to a uniform buffer binding point.
+    GLint BindUniformBlock(const std::string& block, GLuint bindingPoint);
+
     GLuint GetAttributeLocation(const std::string& attribute) const;
     GLuint GetUniformLocation(const std::string& uniform) const;
 
+    // Resolves a uniform once so the render loop can set it without any lookups. Call after linking;
+    // the handle is invalid if the uniform isn't active in the program.
+    template <typename T>
+    UniformHandle<T> GetUniformHandle(const std::string& uniform) const
+    {
+        return UniformHandle<T>(_didLink ? glGetUniformLocation(_shaderProgramHandle, uniform.c_str()) : -1);
+    }
+
     std::string ToString() const;
 
     // Uniform convenience functions =============================================================
+    // These look the name up on every call (in the uniforms added with AddUniform, then the driver), so
+    // prefer a UniformHandle for anything set per frame.
 
     void setBool(const std::string& name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(_shaderProgramHandle, name.c_str()), (int)value);
+        glUniform1i(FindUniformLocation(name), (int)value);
     }
 
     void setInt(const std::string &name, int value) const
     {
-        glUniform1i(glGetUniformLocation(_shaderProgramHandle, name.c_str()), value);
+        glUniform1i(FindUniformLocation(name), value);
     }
 
     void setFloat(const std::string& name, float value) const
     {
-        glUniform1f(glGetUniformLocation(_shaderProgramHandle, name.c_str()), value);
+        glUniform1f(FindUniformLocation(name), value);
     }
 
     void setVec2(const std::string& name, const glm::vec2& value) const
     {
-        glUniform2fv(glGetUniformLocation(_shaderProgramHandle, name.c_str()), 1, &value[0]);
+        glUniform2fv(FindUniformLocation(name), 1, &value[0]);
     }
 
     void setVec2(const std::string& name, float x, float y) const
     {
-        glUniform2f(glGetUniformLocation(_shaderProgramHandle, name.c_str()), x, y);
+        glUniform2f(FindUniformLocation(name), x, y);
     }
 
     void setVec3(const std::string& name, const glm::vec3& value) const
     {
-        glUniform3fv(glGetUniformLocation(_shaderProgramHandle, name.c_str()), 1, &value[0]);
+        glUniform3fv(FindUniformLocation(name), 1, &value[0]);
     }
 
     void setVec3(const std::string& name, float x, float y, float z) const
     {
-        glUniform3f(glGetUniformLocation(_shaderProgramHandle, name.c_str()), x, y, z);
+        glUniform3f(FindUniformLocation(name), x, y, z);
     }
 
     void setVec4(const std::string& name, const glm::vec4& value) const
     {
-        glUniform4fv(glGetUniformLocation(_shaderProgramHandle, name.c_str()), 1, &value[0]);
+        glUniform4fv(FindUniformLocation(name), 1, &value[0]);
     }
     void setVec4(const std::string& name, float x, float y, float z, float w)
     {
-        glUniform4f(glGetUniformLocation(_shaderProgramHandle, name.c_str()), x, y, z, w);
+        glUniform4f(FindUniformLocation(name), x, y, z, w);
     }
 
     void setMat2(const std::string& name, const glm::mat2& mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(_shaderProgramHandle, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix2fv(FindUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
     }
 
     void setMat3(const std::string& name, const glm::mat3& mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(_shaderProgramHandle, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix3fv(FindUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
     }
 
     void setMat4(const std::string& name, const glm::mat4& mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(_shaderProgramHandle, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix4fv(FindUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
     }
 
 private:
+    // Names and their locations, sorted by name: one array rather than a tree node per name. Names too
+    // long for the string's own buffer still allocate.
+    typedef std::vector<std::pair<std::string, GLuint>> LocationList;
+
+    static void SetLocation(LocationList& list, const std::string& name, GLuint location);
+    static bool FindLocation(const LocationList& list, const std::string& name, GLuint& location);
+
+    GLint FindUniformLocation(const std::string& uniform) const;
+
+    void CompileShader(GLenum shaderType, const GLchar* const source, bool waitForStatus);
+    bool CheckCompileStatus(GLuint shader) const;
+    GLuint* GetShaderSlot(GLenum shaderType);
+
+    // Everything the link depends on, from which the binary cache key is made.
+    std::string GetCacheSource() const;
+
+    static ProgramBinaryCache* _binaryCache;
+
     GLuint _shaderProgramHandle;
 
     GLint _didLink; // GL_TRUE if the GLSL program was successfully created and linked
@@ -111,7 +214,18 @@ private:
     GLuint _vertexShader;
     GLuint _fragmentShader;
     GLuint _geometryShader;
+    GLuint _tessControlShader;
+    GLuint _tessEvaluationShader;
+    GLuint _computeShader;      // a compute program has only this stage
+
+    std::vector<std::string> _transformFeedbackVaryings;
+    GLenum _transformFeedbackBufferMode;    // GL_INTERLEAVED_ATTRIBS or GL_SEPARATE_ATTRIBS
+
+    bool _defersCompilation;
+    std::vector<std::pair<GLenum, std::string>> _pendingSources;   // shaders left to compile, when deferred
+    std::string _cacheKey;      // of the binary cache entry the program is stored under, once linked
+    bool _isLinkPending;        // between CreateAndLinkProgramAsync and FinishLink
 
-    std::map<std::string, GLuint> _attributeList;   // maps attribute names to locations
-    std::map<std::string, GLuint> _uniformList;     // maps uniform names to locations
+    LocationList _attributeList;    // maps attribute names to locations
+    LocationList _uniformList;      // maps uniform names to locations
 };
@@ -0,0 +1,72 @@
+#include "GpuTimer.h"
+
+GpuTimer::GpuTimer() :
+        _oldest(0),
+        _pendingCount(0),
+        _droppedCount(0)
+{
+    for (int index = 0; index < QUERY_COUNT; ++index) {
+        _queries[index] = 0;
+    }
+}
+
+GpuTimer::~GpuTimer()
+{
+    Delete();
+}
+
+void GpuTimer::Create()
+{
+    Delete();
+
+    glGenQueries(QUERY_COUNT, _queries);
+    _oldest = 0;
+    _pendingCount = 0;
+    _droppedCount = 0;
+}
+
+void GpuTimer::Delete()
+{
+    if (_queries[0] != 0) {
+        glDeleteQueries(QUERY_COUNT, _queries);
+        for (int index = 0; index < QUERY_COUNT; ++index) {
+            _queries[index] = 0;
+        }
+        _pendingCount = 0;
+    }
+}
+
+void GpuTimer::Begin()
+{
+    // The GPU is a whole ring behind: give up on the oldest query rather than wait for it.
+    if (_pendingCount == QUERY_COUNT) {
+        _oldest = (_oldest + 1) % QUERY_COUNT;
+        --_pendingCount;
+        ++_droppedCount;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, _queries[(_oldest + _pendingCount) % QUERY_COUNT]);
+}
+
+bool GpuTimer::End(double& milliseconds)
+{
+    glEndQuery(GL_TIME_ELAPSED);
+    ++_pendingCount;
+
+    GLint isAvailable = GL_FALSE;
+    glGetQueryObjectiv(_queries[_oldest], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+    if (isAvailable != GL_TRUE) {
+        return false;
+    }
+
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(_queries[_oldest], GL_QUERY_RESULT, &nanoseconds);
+    _oldest = (_oldest + 1) % QUERY_COUNT;
+    --_pendingCount;
+    milliseconds = nanoseconds / 1.0e6;
+    return true;
+}
+
+unsigned long long GpuTimer::GetDroppedCount() const
+{
+    return _droppedCount;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+/**
+ * Measures the GPU time of the commands between Begin() and End() with GL_TIME_ELAPSED queries.
+ *
+ * Query results arrive a frame or more after the commands are issued, and waiting for them would
+ * stall the CPU on the GPU. The timer keeps a ring of queries instead: each frame takes the next one,
+ * and End() picks up the oldest pending result if it has become available, without waiting. Results
+ * come in the order the queries were issued, and a query stays pending until its result is read, so
+ * a measurement is only lost when every query of the ring is still pending at the next Begin().
+ */
+class GpuTimer final
+{
+public:
+    static const int QUERY_COUNT = 4;
+
+    GpuTimer();
+
+    GpuTimer(const GpuTimer& rhs) = delete;
+    GpuTimer(GpuTimer&& rhs) = delete;
+
+    GpuTimer& operator=(const GpuTimer& rhs) = delete;
+    GpuTimer& operator=(GpuTimer&& rhs) = delete;
+
+    ~GpuTimer();
+
+    void Create();
+    void Delete();
+
+    // Drops the oldest pending measurement if the whole ring is pending.
+    void Begin();
+
+    // Returns true and the oldest pending measurement in milliseconds if it has become available.
+    bool End(double& milliseconds);
+
+    // Measurements dropped by Begin() since Create().
+    unsigned long long GetDroppedCount() const;
+
+private:
+    GLuint _queries[QUERY_COUNT];
+    int _oldest;                // the oldest pending query
+    int _pendingCount;          // pending queries, from the oldest on
+    unsigned long long _droppedCount;
+};
@@ -0,0 +1,504 @@
+#include "GridMesh.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+GridMesh::GridMesh() :
+        _quadsX(0),
+        _quadsZ(0),
+        _layout(IndexLayout::Triangles),
+        _quadOrder(QuadOrder::RowMajor),
+        _bandWidth(0),
+        _vertexFormat(VertexFormat::Float),
+        _size(0.0f, 0.0f)
+{ }
+
+GridMesh::~GridMesh()
+{ }
+
+bool GridMesh::Generate(int quadsX, int quadsZ, float sizeX, float sizeZ, IndexLayout layout, VertexFormat format)
+{
+    _quadsX = 0;
+    _quadsZ = 0;
+
+    // clear() keeps the capacity, so regenerating at the same or a lower resolution doesn't allocate.
+    _vertices.clear();
+    _quantizedVertices.clear();
+    _indices16.clear();
+    _indices32.clear();
+    _tiles.clear();
+
+    if (quadsX < 1 || quadsZ < 1) {
+        std::cerr << "GridMesh::Generate: invalid resolution " << quadsX << "x" << quadsZ << std::endl;
+        return false;
+    }
+
+    // Both counts are passed to GL as a GLsizei, and the vertex count must also fit in a GLuint index.
+    const unsigned long long vertexCount = static_cast<unsigned long long>(quadsX + 1) * (quadsZ + 1);
+    const unsigned long long indexCount = CountIndices(quadsX, quadsZ, layout, quadsX);
+    if (indexCount > static_cast<unsigned long long>(std::numeric_limits<GLsizei>::max())) {
+        std::cerr << "GridMesh::Generate: resolution " << quadsX << "x" << quadsZ
+                  << " needs " << indexCount << " indices, which is more than a single draw call can take" << std::endl;
+        return false;
+    }
+    if (format == VertexFormat::Quantized
+            && (quadsX > std::numeric_limits<GLushort>::max() || quadsZ > std::numeric_limits<GLushort>::max())) {
+        std::cerr << "GridMesh::Generate: resolution " << quadsX << "x" << quadsZ
+                  << " has more columns or rows than 16-bit vertices can address" << std::endl;
+        return false;
+    }
+
+    _quadsX = quadsX;
+    _quadsZ = quadsZ;
+    _layout = layout;
+    _quadOrder = QuadOrder::RowMajor;
+    _bandWidth = quadsX;
+    _vertexFormat = format;
+    _size = glm::vec2(sizeX, sizeZ);
+
+    const float halfSizeX = sizeX / 2.0f;
+    const float halfSizeZ = sizeZ / 2.0f;
+
+    // Create the plane vertices.
+    if (_vertexFormat == VertexFormat::Quantized) {
+        // y is always 0 and x/z follow the grid, so the column and row are all a vertex needs.
+        _quantizedVertices.reserve(static_cast<size_t>(vertexCount) * 2);
+        for (int j = 0; j <= _quadsZ; ++j) {
+            for (int i = 0; i <= _quadsX; ++i) {
+                _quantizedVertices.push_back(static_cast<GLushort>(i));
+                _quantizedVertices.push_back(static_cast<GLushort>(j));
+            }
+        }
+    }
+    else {
+        _vertices.reserve(static_cast<size_t>(vertexCount));
+        for (int j = 0; j <= _quadsZ; ++j) {
+            for (int i = 0; i <= _quadsX; ++i) {
+                _vertices.push_back(glm::vec3(
+                    ((static_cast<float>(i) / _quadsX) * 2 - 1) * halfSizeX,
+                    0,
+                    ((static_cast<float>(j) / _quadsZ) * 2 - 1) * halfSizeZ));
+            }
+        }
+    }
+
+    // Fill the plane indices array using the narrowest index type that can address every vertex.
+    if (vertexCount <= std::numeric_limits<GLushort>::max()) {
+        FillIndices(_indices16);
+    }
+    else {
+        FillIndices(_indices32);
+    }
+
+    return true;
+}
+
+bool GridMesh::Reorder(QuadOrder order, int cacheSize)
+{
+    if (GetVertexCount() == 0) {
+        return false;
+    }
+    if (order == QuadOrder::Tiles) {
+        return SplitIntoTiles(std::max(1, cacheSize / 2 - 1));
+    }
+    if (order == QuadOrder::Hilbert && _layout == IndexLayout::Strips) {
+        std::cerr << "GridMesh::Reorder: a Hilbert order needs the triangle or patch layout" << std::endl;
+        return false;
+    }
+
+    // Two rows of band vertices, (bandWidth + 1) each, have to fit in the cache for every vertex of the
+    // previous row to still be cached when the next row reuses it.
+    int bandWidth = _quadsX;
+    if (order == QuadOrder::Bands) {
+        bandWidth = std::max(1, std::min(_quadsX, cacheSize / 2 - 1));
+    }
+
+    if (CountIndices(_quadsX, _quadsZ, _layout, bandWidth) > static_cast<unsigned long long>(std::numeric_limits<GLsizei>::max())) {
+        std::cerr << "GridMesh::Reorder: the reordered indices don't fit in a single draw call" << std::endl;
+        return false;
+    }
+
+    _quadOrder = order;
+    _bandWidth = bandWidth;
+
+    if (_indices32.empty()) {
+        FillIndices(_indices16);
+    }
+    else {
+        FillIndices(_indices32);
+    }
+
+    return true;
+}
+
+bool GridMesh::SplitIntoTiles(int tileQuads)
+{
+    if (GetVertexCount() == 0) {
+        return false;
+    }
+    if (tileQuads < 1) {
+        std::cerr << "GridMesh::SplitIntoTiles: invalid tile size " << tileQuads << std::endl;
+        return false;
+    }
+
+    // Each row of a tile is a band row, so the strip index count is that of bands of the tile width.
+    const int tileWidth = std::min(tileQuads, std::max(_quadsX, _quadsZ));
+    if (CountIndices(_quadsX, _quadsZ, _layout, std::min(tileWidth, _quadsX)) > static_cast<unsigned long long>(std::numeric_limits<GLsizei>::max())) {
+        std::cerr << "GridMesh::SplitIntoTiles: the tiled indices don't fit in a single draw call" << std::endl;
+        return false;
+    }
+
+    _quadOrder = QuadOrder::Tiles;
+    _bandWidth = tileWidth;
+
+    if (_indices32.empty()) {
+        FillIndices(_indices16);
+    }
+    else {
+        FillIndices(_indices32);
+    }
+
+    return true;
+}
+
+const std::vector<GridTile>& GridMesh::GetTiles() const
+{
+    return _tiles;
+}
+
+double GridMesh::ComputeAcmr(int cacheSize) const
+{
+    return _indices32.empty() ? SimulateFifoCache(_indices16, cacheSize) : SimulateFifoCache(_indices32, cacheSize);
+}
+
+template <typename IndexType>
+double GridMesh::SimulateFifoCache(const std::vector<IndexType>& indices, int cacheSize) const
+{
+    const IndexType restartIndex = std::numeric_limits<IndexType>::max();
+
+    // A vertex is still cached if fewer than cacheSize misses happened since it was last loaded, so
+    // remembering the miss count at load time is enough to model the FIFO.
+    std::vector<unsigned long long> loadedAt(static_cast<size_t>(GetVertexCount()), 0);
+    unsigned long long misses = 0;
+    unsigned long long triangles = 0;
+    unsigned long long stripLength = 0;
+
+    for (size_t index = 0; index < indices.size(); ++index) {
+        const IndexType vertex = indices[index];
+
+        if (_layout == IndexLayout::Strips) {
+            if (vertex == restartIndex) {
+                stripLength = 0;
+                continue;
+            }
+            if (++stripLength >= 3) {
+                ++triangles;
+            }
+        }
+
+        if (loadedAt[vertex] == 0 || misses - loadedAt[vertex] >= static_cast<unsigned long long>(cacheSize)) {
+            loadedAt[vertex] = ++misses;
+        }
+    }
+
+    if (_layout == IndexLayout::Triangles) {
+        triangles = indices.size() / 3;
+    }
+    else if (_layout == IndexLayout::Patches) {
+        // Before tessellation each patch stands for the two triangles of its quad.
+        triangles = indices.size() / 4 * 2;
+    }
+
+    return triangles ? static_cast<double>(misses) / triangles : 0.0;
+}
+
+unsigned long long GridMesh::CountIndices(int quadsX, int quadsZ, IndexLayout layout, int bandWidth) const
+{
+    if (layout == IndexLayout::Strips) {
+        // 2 indices per column of vertices in each row of each band, plus a restart index between strips.
+        const unsigned long long bands = (quadsX + bandWidth - 1) / bandWidth;
+        return (static_cast<unsigned long long>(quadsX) + bands) * 2 * quadsZ + (bands * quadsZ - 1);
+    }
+    if (layout == IndexLayout::Patches) {
+        return static_cast<unsigned long long>(quadsX) * quadsZ * 4;
+    }
+    return static_cast<unsigned long long>(quadsX) * quadsZ * 2 * 3;
+}
+
+template <typename IndexType>
+void GridMesh::FillIndices(std::vector<IndexType>& indices)
+{
+    indices.resize(static_cast<size_t>(CountIndices(_quadsX, _quadsZ, _layout, std::min(_bandWidth, _quadsX))));
+    _tiles.clear();
+
+    if (_quadOrder == QuadOrder::Tiles) {
+        FillTileIndices(indices.data());
+    }
+    else if (_layout == IndexLayout::Strips) {
+        FillStripIndices(indices.data());
+    }
+    else {
+        // Triangles and patches visit the quads in the same order; AddQuad writes either.
+        FillTriangleIndices(indices.data());
+    }
+}
+
+// Maps a distance along a Hilbert curve covering an n x n grid (n a power of two) to grid coordinates.
+// The curve starts at (0, 0) and ends at (n - 1, 0).
+static void HilbertToGrid(unsigned int n, unsigned long long distance, unsigned int& x, unsigned int& y)
+{
+    x = y = 0;
+    for (unsigned int s = 1; s < n; s *= 2) {
+        unsigned int rx = static_cast<unsigned int>(1 & (distance / 2));
+        unsigned int ry = static_cast<unsigned int>(1 & (distance ^ rx));
+        if (ry == 0) {
+            if (rx == 1) {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            std::swap(x, y);
+        }
+        x += s * rx;
+        y += s * ry;
+        distance /= 4;
+    }
+}
+
+template <typename IndexType>
+void GridMesh::FillTriangleIndices(IndexType* id) const
+{
+    if (_quadOrder == QuadOrder::Hilbert) {
+        // Walk the curve over power of two squares covering the short side, one after the other along
+        // the long side, skipping quads outside the grid. Each curve ends next to where the next one
+        // starts, and the squares waste less than five quads for each one in the grid, however skinny
+        // it is; a square grid is a single curve.
+        const bool isAlongX = _quadsX >= _quadsZ;
+        const unsigned int longSide = static_cast<unsigned int>(isAlongX ? _quadsX : _quadsZ);
+        const unsigned int shortSide = static_cast<unsigned int>(isAlongX ? _quadsZ : _quadsX);
+        unsigned int n = 1;
+        while (n < shortSide) {
+            n *= 2;
+        }
+
+        const unsigned long long curveLength = static_cast<unsigned long long>(n) * n;
+        for (unsigned long long squareStart = 0; squareStart < longSide; squareStart += n) {
+            for (unsigned long long distance = 0; distance < curveLength; ++distance) {
+                unsigned int along, across;
+                HilbertToGrid(n, distance, along, across);
+                const unsigned long long position = squareStart + along;
+                if (position < longSide && across < shortSide) {
+                    const int column = static_cast<int>(isAlongX ? position : across);
+                    const int row = static_cast<int>(isAlongX ? across : position);
+                    AddQuad(id, row, column);
+                }
+            }
+        }
+        return;
+    }
+
+    for (int bandStart = 0; bandStart < _quadsX; bandStart += _bandWidth) {
+        const int bandEnd = std::min(bandStart + _bandWidth, _quadsX);
+        for (int i = 0; i < _quadsZ; ++i) {
+            for (int j = bandStart; j < bandEnd; ++j) {
+                AddQuad(id, i, j);
+            }
+        }
+    }
+}
+
+template <typename IndexType>
+void GridMesh::FillTileIndices(IndexType* indices)
+{
+    const IndexType restartIndex = std::numeric_limits<IndexType>::max();
+    const int tileQuads = _bandWidth;
+    IndexType* id = indices;
+
+    for (int tileRow = 0; tileRow < _quadsZ; tileRow += tileQuads) {
+        for (int tileColumn = 0; tileColumn < _quadsX; tileColumn += tileQuads) {
+            GridTile tile;
+            tile.firstColumn = tileColumn;
+            tile.firstRow = tileRow;
+            tile.columns = std::min(tileQuads, _quadsX - tileColumn);
+            tile.rows = std::min(tileQuads, _quadsZ - tileRow);
+
+            // The restart index between tiles stays outside both ranges, so each tile draws on its own.
+            if (_layout == IndexLayout::Strips && id != indices) {
+                *id++ = restartIndex;
+            }
+            tile.firstIndex = static_cast<GLsizei>(id - indices);
+
+            for (int i = tileRow; i < tileRow + tile.rows; ++i) {
+                if (_layout == IndexLayout::Strips) {
+                    if (i != tileRow) {
+                        *id++ = restartIndex;
+                    }
+                    for (int j = tileColumn; j <= tileColumn + tile.columns; ++j) {
+                        IndexType i0 = static_cast<IndexType>(i * (_quadsX + 1) + j);
+                        *id++ = i0;
+                        *id++ = i0 + (_quadsX + 1);
+                    }
+                }
+                else {
+                    for (int j = tileColumn; j < tileColumn + tile.columns; ++j) {
+                        AddQuad(id, i, j);
+                    }
+                }
+            }
+
+            tile.indexCount = static_cast<GLsizei>(id - indices) - tile.firstIndex;
+            _tiles.push_back(tile);
+        }
+    }
+}
+
+template <typename IndexType>
+void GridMesh::AddQuad(IndexType*& id, int row, int column) const
+{
+    IndexType i0 = static_cast<IndexType>(row * (_quadsX + 1) + column);
+    IndexType i1 = i0 + 1;
+    IndexType i2 = i0 + (_quadsX + 1);
+    IndexType i3 = i2 + 1;
+
+    // A patch lists its corners counterclockwise, as the quads tessellation domain expects.
+    if (_layout == IndexLayout::Patches) {
+        *id++ = i0;
+        *id++ = i1;
+        *id++ = i3;
+        *id++ = i2;
+        return;
+    }
+
+    // Alternate the diagonal so the triangles don't all lean the same way.
+    if ((column + row) % 2) {
+        *id++ = i0;
+        *id++ = i2;
+        *id++ = i1;
+        *id++ = i1;
+        *id++ = i2;
+        *id++ = i3;
+    }
+    else {
+        *id++ = i0;
+        *id++ = i2;
+        *id++ = i3;
+        *id++ = i0;
+        *id++ = i3;
+        *id++ = i1;
+    }
+}
+
+template <typename IndexType>
+void GridMesh::FillStripIndices(IndexType* id) const
+{
+    const IndexType restartIndex = std::numeric_limits<IndexType>::max();
+    bool isFirstStrip = true;
+
+    for (int bandStart = 0; bandStart < _quadsX; bandStart += _bandWidth) {
+        const int bandEnd = std::min(bandStart + _bandWidth, _quadsX);
+        for (int i = 0; i < _quadsZ; ++i) {
+            if (!isFirstStrip) {
+                *id++ = restartIndex;
+            }
+            isFirstStrip = false;
+
+            // Zig-zag between this row's near and far edge: (0, i), (0, i + 1), (1, i), (1, i + 1), ...
+            for (int j = bandStart; j <= bandEnd; ++j) {
+                IndexType i0 = static_cast<IndexType>(i * (_quadsX + 1) + j);
+                *id++ = i0;
+                *id++ = i0 + (_quadsX + 1);
+            }
+        }
+    }
+}
+
+int GridMesh::GetQuadsX() const
+{
+    return _quadsX;
+}
+
+int GridMesh::GetQuadsZ() const
+{
+    return _quadsZ;
+}
+
+GLsizei GridMesh::GetVertexCount() const
+{
+    return _quadsX ? (_quadsX + 1) * (_quadsZ + 1) : 0;
+}
+
+GLsizei GridMesh::GetIndexCount() const
+{
+    return static_cast<GLsizei>(_indices32.empty() ? _indices16.size() : _indices32.size());
+}
+
+IndexLayout GridMesh::GetIndexLayout() const
+{
+    return _layout;
+}
+
+QuadOrder GridMesh::GetQuadOrder() const
+{
+    return _quadOrder;
+}
+
+GLenum GridMesh::GetPrimitiveType() const
+{
+    switch (_layout) {
+        case IndexLayout::Strips :
+            return GL_TRIANGLE_STRIP;
+        case IndexLayout::Patches :
+            return GL_PATCHES;
+        default :
+            return GL_TRIANGLES;
+    }
+}
+
+GLenum GridMesh::GetIndexType() const
+{
+    return _indices32.empty() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+GLuint GridMesh::GetRestartIndex() const
+{
+    return _indices32.empty() ? std::numeric_limits<GLushort>::max() : std::numeric_limits<GLuint>::max();
+}
+
+VertexFormat GridMesh::GetVertexFormat() const
+{
+    return _vertexFormat;
+}
+
+glm::vec2 GridMesh::GetQuantizedScale() const
+{
+    return glm::vec2(_size.x / _quadsX, _size.y / _quadsZ);
+}
+
+glm::vec2 GridMesh::GetQuantizedOffset() const
+{
+    return _size * -0.5f;
+}
+
+const GLvoid* GridMesh::GetVertexData() const
+{
+    return _vertexFormat == VertexFormat::Quantized ? static_cast<const GLvoid*>(_quantizedVertices.data())
+                                                    : static_cast<const GLvoid*>(_vertices.data());
+}
+
+const GLvoid* GridMesh::GetIndexData() const
+{
+    return _indices32.empty() ? static_cast<const GLvoid*>(_indices16.data())
+                              : static_cast<const GLvoid*>(_indices32.data());
+}
+
+GLsizeiptr GridMesh::GetVertexDataSize() const
+{
+    return _vertexFormat == VertexFormat::Quantized ? static_cast<GLsizeiptr>(_quantizedVertices.size() * sizeof(GLushort))
+                                                    : static_cast<GLsizeiptr>(_vertices.size() * sizeof(glm::vec3));
+}
+
+GLsizeiptr GridMesh::GetIndexDataSize() const
+{
+    return _indices32.empty() ? static_cast<GLsizeiptr>(_indices16.size() * sizeof(GLushort))
+                              : static_cast<GLsizeiptr>(_indices32.size() * sizeof(GLuint));
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <vector>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+// GLM: OpenGL Math
+#include <glm/glm.hpp>
+
+// How the grid's quads are turned into indices.
+enum class IndexLayout
+{
+    Triangles,  // independent triangles, 6 indices per quad with an alternating diagonal
+    Strips,     // one triangle strip per row of quads, rows joined by a primitive restart index
+    Patches     // 4 indices per quad, drawn as GL_PATCHES and tessellated on the GPU
+};
+
+// The order in which quads are visited when the indices are generated.
+enum class QuadOrder
+{
+    RowMajor,   // one row of quads after another
+    Bands,      // column bands narrow enough for two rows of a band to stay in the vertex cache
+    Hilbert,    // along a Hilbert curve; not for strips
+    Tiles       // square tiles one after another, each a contiguous index range; see GridMesh::SplitIntoTiles
+};
+
+// A square block of quads whose indices are contiguous, so it can be drawn or skipped on its own.
+struct GridTile
+{
+    int firstColumn;
+    int firstRow;
+    int columns;
+    int rows;
+
+    GLsizei firstIndex;
+    GLsizei indexCount;
+};
+
+// How the grid's vertices are stored.
+enum class VertexFormat
+{
+    Float,      // x, y, z as floats; 12 bytes per vertex
+    Quantized   // column and row as 16-bit unsigned integers, mapped to x/z by GetQuantizedScale/Offset; 4 bytes
+};
+
+/**
+ * A planar grid of quads in the x/z plane, centered on the origin.
+ *
+ * The resolution is chosen at runtime. Vertex and index data live in heap buffers that are reused
+ * when the grid is regenerated, and the index type is picked from the vertex count: 16-bit indices
+ * while every vertex fits in a GLushort, 32-bit indices otherwise.
+ */
+class GridMesh final
+{
+public:
+    GridMesh();
+
+    GridMesh(const GridMesh& rhs) = delete;
+    GridMesh(GridMesh&& rhs) = delete;
+
+    GridMesh& operator=(const GridMesh& rhs) = delete;
+    GridMesh& operator=(GridMesh&& rhs) = delete;
+
+    ~GridMesh();
+
+    // Returns false (and leaves the mesh empty) if the resolution can't be drawn with one call.
+    bool Generate(int quadsX, int quadsZ, float sizeX, float sizeZ, IndexLayout layout = IndexLayout::Triangles,
+                  VertexFormat format = VertexFormat::Float);
+
+    // Regenerates the indices of the current grid so that quads are visited in the given order. The
+    // cache size is the number of entries of the post-transform vertex cache being targeted; it sets
+    // the width of the bands for QuadOrder::Bands.
+    bool Reorder(QuadOrder order, int cacheSize);
+
+    // Regenerates the indices of the current grid tile by tile, tileQuads x tileQuads quads each
+    // (smaller along the far edges), with the quads of a tile in row-major order. Tiles no wider than
+    // half the vertex cache keep the row-major reuse.
+    bool SplitIntoTiles(int tileQuads);
+
+    // The tiles of QuadOrder::Tiles, row-major; empty for the other orders.
+    const std::vector<GridTile>& GetTiles() const;
+
+    // Simulates a FIFO post-transform vertex cache of the given size over the index buffer and returns
+    // the average cache miss ratio: vertex shader invocations per triangle. 0.5 is the ideal for a grid.
+    double ComputeAcmr(int cacheSize) const;
+
+    int GetQuadsX() const;
+    int GetQuadsZ() const;
+
+    GLsizei GetVertexCount() const;
+    GLsizei GetIndexCount() const;
+
+    IndexLayout GetIndexLayout() const;
+    QuadOrder GetQuadOrder() const;
+    VertexFormat GetVertexFormat() const;
+
+    // x/z = column/row * scale + offset for VertexFormat::Quantized vertices.
+    glm::vec2 GetQuantizedScale() const;
+    glm::vec2 GetQuantizedOffset() const;
+
+    // GL_TRIANGLES, GL_TRIANGLE_STRIP or GL_PATCHES, as expected by glDrawElements.
+    GLenum GetPrimitiveType() const;
+
+    // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, as expected by glDrawElements.
+    GLenum GetIndexType() const;
+
+    // The largest value of the index type; strips use it with glPrimitiveRestartIndex to separate rows.
+    GLuint GetRestartIndex() const;
+
+    const GLvoid* GetVertexData() const;
+    const GLvoid* GetIndexData() const;
+
+    GLsizeiptr GetVertexDataSize() const;
+    GLsizeiptr GetIndexDataSize() const;
+
+private:
+    template <typename IndexType>
+    void FillIndices(std::vector<IndexType>& indices);
+
+    template <typename IndexType>
+    void FillTriangleIndices(IndexType* id) const;
+
+    template <typename IndexType>
+    void FillStripIndices(IndexType* id) const;
+
+    template <typename IndexType>
+    void FillTileIndices(IndexType* indices);
+
+    template <typename IndexType>
+    void AddQuad(IndexType*& id, int row, int column) const;
+
+    template <typename IndexType>
+    double SimulateFifoCache(const std::vector<IndexType>& indices, int cacheSize) const;
+
+    unsigned long long CountIndices(int quadsX, int quadsZ, IndexLayout layout, int bandWidth) const;
+
+    int _quadsX;
+    int _quadsZ;
+    IndexLayout _layout;
+    QuadOrder _quadOrder;
+    int _bandWidth;     // columns of quads per band or tile; _quadsX unless the order is QuadOrder::Bands or Tiles
+    VertexFormat _vertexFormat;
+    glm::vec2 _size;
+
+    std::vector<glm::vec3> _vertices;               // used with VertexFormat::Float
+    std::vector<GLushort> _quantizedVertices;       // used with VertexFormat::Quantized, 2 per vertex
+    std::vector<GLushort> _indices16;   // used when the vertex count fits in 16 bits (0xFFFF stays free for restarts)
+    std::vector<GLuint> _indices32;     // used otherwise
+
+    std::vector<GridTile> _tiles;
+};
@@ -0,0 +1,10 @@
+#version 330 core
+
+layout (location = 0) out vec4 fragmentColor;
+
+in vec4 vertexColor;    // the instance color, from InstancedVertex.shader
+
+void main()
+{
+    fragmentColor = vertexColor;
+}
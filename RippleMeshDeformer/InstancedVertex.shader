@@ -0,0 +1,31 @@
+#version 330 core
+
+// Vertex.shader for SurfaceInstances: every instance is a separate surface with its own transform,
+// phase and color, read from the instance buffer.
+
+layout (location = 0) in vec3 vertex;
+layout (location = 1) in mat4 instanceModel;    // locations 1 to 4, INSTANCE_MODEL_LOCATION
+layout (location = 5) in vec4 instanceColor;    // INSTANCE_COLOR_LOCATION
+layout (location = 6) in float instancePhase;   // INSTANCE_PHASE_LOCATION
+
+layout (std140) uniform FrameUniforms  // filled from the FrameUniforms struct in FrameUniforms.h
+{
+    mat4 modelViewProjectMatrix;    // view and projection only; each instance brings its model matrix
+    vec4 newColor;
+    vec2 waveCenter;
+    float waveTime;
+    float amplitude;
+    float frequency;
+};
+
+out vec4 vertexColor;
+
+const float PI = 3.14159;
+
+void main()
+{
+    float distance = length(vertex.xz - waveCenter);
+    float y = amplitude * sin(-PI * distance * frequency + waveTime + instancePhase);
+    vertexColor = instanceColor;
+    gl_Position = modelViewProjectMatrix * instanceModel * vec4(vertex.x, y, vertex.z, 1);
+}
@@ -0,0 +1,74 @@
+#version 330 core
+
+// Draws one LodPatches patch: the vertices are columns and rows of the finest patch grid.
+//
+// Variants, selected with #defines (see ShaderVariants), as in Vertex.shader:
+//   USE_LIGHTING      1 also outputs the analytic normal of the ripple for the lit Fragment.shader
+//   USE_FAR_FIELD     1 fades the displacement out between FAR_FIELD_START and FAR_FIELD_END from the
+//                     camera, leaving the ripple to the per-pixel normals of Fragment.shader
+
+#ifndef USE_LIGHTING
+#define USE_LIGHTING 0
+#endif
+#ifndef USE_FAR_FIELD
+#define USE_FAR_FIELD 0
+#endif
+
+layout (location = 0) in vec2 gridPoint;    // 16-bit unsigned column and row within the patch
+
+layout (std140) uniform FrameUniforms  // filled from the FrameUniforms struct in FrameUniforms.h
+{
+    mat4 modelViewProjectMatrix;
+    vec4 newColor;
+    vec2 waveCenter;
+    float waveTime;
+    float amplitude;
+    float frequency;
+};
+
+// Column and row of the patch's first vertex in the whole field. Added as integers so that patches
+// sharing an edge compute bit-identical positions for it.
+uniform ivec2 patchOrigin;
+
+// x/z = (patchOrigin + gridPoint) * gridScale + gridOffset, from LodPatches::GetGridScale/Offset
+uniform vec2 gridScale;
+uniform vec2 gridOffset;
+
+#if USE_LIGHTING
+out vec3 vertexNormal;
+#endif
+#if USE_FAR_FIELD
+uniform vec3 cameraPosition;    // in world space
+
+out vec2 surfacePosition;       // x/z, for the per-pixel ripple
+out float farFieldWeight;       // share of the ripple left to Fragment.shader, 0 to 1
+#endif
+
+const float PI = 3.14159;
+
+void main()
+{
+    vec2 vertex = vec2(patchOrigin + ivec2(gridPoint)) * gridScale + gridOffset;
+    vec2 offset = vertex - waveCenter;
+    float distance = length(offset);
+    float phase = -PI * distance * frequency + waveTime;
+    float y = amplitude * sin(phase);
+
+#if USE_FAR_FIELD
+    // Patches past FAR_FIELD_END are flat, so LodPatches draws them at the coarsest level.
+    farFieldWeight = smoothstep(FAR_FIELD_START, FAR_FIELD_END, length(vec3(vertex.x, 0, vertex.y) - cameraPosition));
+    surfacePosition = vertex;
+    y *= 1 - farFieldWeight;
+#endif
+
+#if USE_LIGHTING
+    float slope = -amplitude * PI * frequency * cos(phase);
+#if USE_FAR_FIELD
+    slope *= 1 - farFieldWeight;
+#endif
+    vec2 gradient = distance > 0 ? slope * offset / distance : vec2(0);
+    vertexNormal = normalize(vec3(-gradient.x, 1, -gradient.y));
+#endif
+
+    gl_Position = modelViewProjectMatrix * vec4(vertex.x, y, vertex.y, 1);
+}
@@ -0,0 +1,250 @@
+#include "LodPatches.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+LodPatches::LodPatches() :
+        _patchesX(0),
+        _patchesZ(0),
+        _size(0.0f, 0.0f),
+        _lodDistance(0.0f),
+        _flatDistance(0.0f),
+        _triangleCount(0)
+{ }
+
+LodPatches::~LodPatches()
+{ }
+
+bool LodPatches::Init(int patchesX, int patchesZ, float sizeX, float sizeZ, float lodDistance)
+{
+    if (patchesX < 1 || patchesZ < 1) {
+        std::cerr << "LodPatches::Init: invalid patch count " << patchesX << "x" << patchesZ << std::endl;
+        return false;
+    }
+
+    _patchesX = patchesX;
+    _patchesZ = patchesZ;
+    _size = glm::vec2(sizeX, sizeZ);
+    _lodDistance = lodDistance;
+
+    _vertices.clear();
+    _vertices.reserve((PATCH_QUADS + 1) * (PATCH_QUADS + 1) * 2);
+    for (int row = 0; row <= PATCH_QUADS; ++row) {
+        for (int column = 0; column <= PATCH_QUADS; ++column) {
+            _vertices.push_back(static_cast<GLushort>(column));
+            _vertices.push_back(static_cast<GLushort>(row));
+        }
+    }
+
+    // The coarsest level is never next to a coarser patch, so it only needs the plain variant.
+    _indices.clear();
+    _rangeStarts.assign(LEVEL_COUNT * COARSE_EDGE_COMBINATIONS, 0);
+    _rangeCounts.assign(LEVEL_COUNT * COARSE_EDGE_COMBINATIONS, 0);
+    for (int level = 0; level < LEVEL_COUNT; ++level) {
+        const int combinations = (level + 1 < LEVEL_COUNT) ? COARSE_EDGE_COMBINATIONS : 1;
+        for (int coarseEdges = 0; coarseEdges < combinations; ++coarseEdges) {
+            AddIndexRange(level, coarseEdges);
+        }
+    }
+
+    _levels.assign(static_cast<size_t>(_patchesX) * _patchesZ, 0);
+    _draws.clear();
+    _draws.reserve(_levels.size());
+    _triangleCount = 0;
+
+    return true;
+}
+
+void LodPatches::AddIndexRange(int level, int coarseEdges)
+{
+    const int step = 1 << level;
+    const int quads = PATCH_QUADS / step;
+    const size_t range = level * COARSE_EDGE_COMBINATIONS + coarseEdges;
+
+    _rangeStarts[range] = static_cast<GLsizei>(_indices.size());
+
+    // Maps a vertex of the level's grid to the finest grid, collapsing the odd vertices of the edges
+    // shared with a coarser patch onto the previous vertex of the edge.
+    struct Snap
+    {
+        int quads, step, coarseEdges;
+
+        GLushort operator()(int column, int row) const
+        {
+            if ((row == 0 && (coarseEdges & COARSE_NEGATIVE_Z)) || (row == quads && (coarseEdges & COARSE_POSITIVE_Z))) {
+                column &= ~1;
+            }
+            if ((column == 0 && (coarseEdges & COARSE_NEGATIVE_X)) || (column == quads && (coarseEdges & COARSE_POSITIVE_X))) {
+                row &= ~1;
+            }
+            return static_cast<GLushort>(row * step * (PATCH_QUADS + 1) + column * step);
+        }
+    };
+    const Snap snap = { quads, step, coarseEdges };
+
+    for (int row = 0; row < quads; ++row) {
+        for (int column = 0; column < quads; ++column) {
+            GLushort i0 = snap(column, row);
+            GLushort i1 = snap(column + 1, row);
+            GLushort i2 = snap(column, row + 1);
+            GLushort i3 = snap(column + 1, row + 1);
+
+            // Same alternating diagonal as GridMesh.
+            GLushort triangles[6];
+            if ((column + row) % 2) {
+                const GLushort quad[6] = { i0, i2, i1, i1, i2, i3 };
+                std::copy(quad, quad + 6, triangles);
+            }
+            else {
+                const GLushort quad[6] = { i0, i2, i3, i0, i3, i1 };
+                std::copy(quad, quad + 6, triangles);
+            }
+
+            // Collapsing an edge vertex leaves some triangles degenerate; they are dropped.
+            for (int triangle = 0; triangle < 6; triangle += 3) {
+                const GLushort* t = triangles + triangle;
+                if (t[0] != t[1] && t[1] != t[2] && t[0] != t[2]) {
+                    _indices.insert(_indices.end(), t, t + 3);
+                }
+            }
+        }
+    }
+
+    _rangeCounts[range] = static_cast<GLsizei>(_indices.size()) - _rangeStarts[range];
+}
+
+void LodPatches::SetFlatDistance(float flatDistance)
+{
+    _flatDistance = flatDistance;
+}
+
+void LodPatches::SelectLevels(const glm::vec3& cameraPosition)
+{
+    const glm::vec2 patchSize(_size.x / _patchesX, _size.y / _patchesZ);
+
+    // Level from the distance between the camera and the closest point of each patch.
+    for (int z = 0; z < _patchesZ; ++z) {
+        for (int x = 0; x < _patchesX; ++x) {
+            const float minX = -_size.x / 2.0f + x * patchSize.x;
+            const float minZ = -_size.y / 2.0f + z * patchSize.y;
+            const float dx = cameraPosition.x - std::max(minX, std::min(cameraPosition.x, minX + patchSize.x));
+            const float dz = cameraPosition.z - std::max(minZ, std::min(cameraPosition.z, minZ + patchSize.y));
+            const float distance = std::sqrt(dx * dx + cameraPosition.y * cameraPosition.y + dz * dz);
+
+            int level = 0;
+            if (_flatDistance > 0.0f && distance > _flatDistance) {
+                level = LEVEL_COUNT - 1;
+            }
+            else if (distance > _lodDistance) {
+                level = 1 + static_cast<int>(std::log2(distance / _lodDistance));
+            }
+            _levels[z * _patchesX + x] = std::min(level, LEVEL_COUNT - 1);
+        }
+    }
+
+    // Refine patches until no neighbor is more than one level finer. Levels only go down, so this
+    // settles after at most LEVEL_COUNT passes.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int z = 0; z < _patchesZ; ++z) {
+            for (int x = 0; x < _patchesX; ++x) {
+                int& level = _levels[z * _patchesX + x];
+                int limit = level;
+                if (x > 0)             { limit = std::min(limit, _levels[z * _patchesX + x - 1] + 1); }
+                if (x + 1 < _patchesX) { limit = std::min(limit, _levels[z * _patchesX + x + 1] + 1); }
+                if (z > 0)             { limit = std::min(limit, _levels[(z - 1) * _patchesX + x] + 1); }
+                if (z + 1 < _patchesZ) { limit = std::min(limit, _levels[(z + 1) * _patchesX + x] + 1); }
+                if (limit < level) {
+                    level = limit;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    _draws.clear();
+    _triangleCount = 0;
+    for (int z = 0; z < _patchesZ; ++z) {
+        for (int x = 0; x < _patchesX; ++x) {
+            const int level = _levels[z * _patchesX + x];
+
+            int coarseEdges = 0;
+            if (x > 0 && _levels[z * _patchesX + x - 1] > level)             { coarseEdges |= COARSE_NEGATIVE_X; }
+            if (x + 1 < _patchesX && _levels[z * _patchesX + x + 1] > level) { coarseEdges |= COARSE_POSITIVE_X; }
+            if (z > 0 && _levels[(z - 1) * _patchesX + x] > level)           { coarseEdges |= COARSE_NEGATIVE_Z; }
+            if (z + 1 < _patchesZ && _levels[(z + 1) * _patchesX + x] > level) { coarseEdges |= COARSE_POSITIVE_Z; }
+
+            const size_t range = level * COARSE_EDGE_COMBINATIONS + coarseEdges;
+
+            PatchDraw draw;
+            draw.origin = glm::ivec2(x * PATCH_QUADS, z * PATCH_QUADS);
+            draw.indexCount = _rangeCounts[range];
+            draw.indexOffset = static_cast<GLsizeiptr>(_rangeStarts[range]) * sizeof(GLushort);
+            _draws.push_back(draw);
+
+            _triangleCount += draw.indexCount / 3;
+        }
+    }
+}
+
+const std::vector<PatchDraw>& LodPatches::GetPatchDraws() const
+{
+    return _draws;
+}
+
+int LodPatches::GetPatchesX() const
+{
+    return _patchesX;
+}
+
+int LodPatches::GetPatchesZ() const
+{
+    return _patchesZ;
+}
+
+unsigned long long LodPatches::GetTriangleCount() const
+{
+    return _triangleCount;
+}
+
+unsigned long long LodPatches::GetFullResolutionTriangleCount() const
+{
+    return static_cast<unsigned long long>(_patchesX) * _patchesZ * PATCH_QUADS * PATCH_QUADS * 2;
+}
+
+glm::vec2 LodPatches::GetGridScale() const
+{
+    return glm::vec2(_size.x / (_patchesX * PATCH_QUADS), _size.y / (_patchesZ * PATCH_QUADS));
+}
+
+glm::vec2 LodPatches::GetGridOffset() const
+{
+    return _size * -0.5f;
+}
+
+GLsizei LodPatches::GetVertexCount() const
+{
+    return static_cast<GLsizei>(_vertices.size() / 2);
+}
+
+const GLvoid* LodPatches::GetVertexData() const
+{
+    return _vertices.data();
+}
+
+const GLvoid* LodPatches::GetIndexData() const
+{
+    return _indices.data();
+}
+
+GLsizeiptr LodPatches::GetVertexDataSize() const
+{
+    return static_cast<GLsizeiptr>(_vertices.size() * sizeof(GLushort));
+}
+
+GLsizeiptr LodPatches::GetIndexDataSize() const
+{
+    return static_cast<GLsizeiptr>(_indices.size() * sizeof(GLushort));
+}
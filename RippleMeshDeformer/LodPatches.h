@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+// GLM: OpenGL Math
+#include <glm/glm.hpp>
+
+// One patch to draw for the frame, at the level picked by LodPatches::SelectLevels.
+struct PatchDraw
+{
+    glm::ivec2 origin;          // column and row of the patch's first vertex in the finest grid
+    GLsizei indexCount;
+    GLsizeiptr indexOffset;     // in bytes, into the index buffer
+};
+
+/**
+ * A large ripple field drawn as a grid of square patches, each at a level of detail picked from
+ * its distance to the camera, so far patches don't spend vertices on sub-pixel triangles.
+ *
+ * All patches share one vertex buffer: the PATCH_QUADS x PATCH_QUADS grid of the finest level,
+ * stored as 16-bit columns and rows and placed in the world by the patchOrigin uniform. Level L
+ * draws every 2^L-th column and row of it. The index buffer holds every level once per combination
+ * of coarser neighbors: along an edge shared with a coarser patch, every other edge vertex is
+ * collapsed onto the previous one, so both patches use the same edge vertices and no cracks open.
+ * Levels are picked so that neighbors never differ by more than one.
+ */
+class LodPatches final
+{
+public:
+    // Quads along a patch side at the finest level, and the number of levels down to one quad.
+    static const int PATCH_QUADS = 64;
+    static const int LEVEL_COUNT = 7;
+
+    LodPatches();
+
+    LodPatches(const LodPatches& rhs) = delete;
+    LodPatches(LodPatches&& rhs) = delete;
+
+    LodPatches& operator=(const LodPatches& rhs) = delete;
+    LodPatches& operator=(LodPatches&& rhs) = delete;
+
+    ~LodPatches();
+
+    // Covers a sizeX x sizeZ plane centered on the origin with patchesX x patchesZ patches. Patches
+    // closer than lodDistance are drawn at the finest level, and each doubling of the distance past
+    // it halves the resolution.
+    bool Init(int patchesX, int patchesZ, float sizeX, float sizeZ, float lodDistance);
+
+    // Patches entirely farther than flatDistance are drawn at the coarsest level, for a far field whose
+    // ripple is left to the fragment shader; 0 (the default) picks every level by distance alone.
+    void SetFlatDistance(float flatDistance);
+
+    // Picks the level of every patch for the camera position, in world space, and fills the draws.
+    void SelectLevels(const glm::vec3& cameraPosition);
+
+    const std::vector<PatchDraw>& GetPatchDraws() const;
+
+    int GetPatchesX() const;
+    int GetPatchesZ() const;
+
+    // Triangles drawn by the last SelectLevels(), and with every patch at the finest level.
+    unsigned long long GetTriangleCount() const;
+    unsigned long long GetFullResolutionTriangleCount() const;
+
+    // World x/z = (patchOrigin + column/row) * scale + offset.
+    glm::vec2 GetGridScale() const;
+    glm::vec2 GetGridOffset() const;
+
+    GLsizei GetVertexCount() const;
+
+    const GLvoid* GetVertexData() const;
+    const GLvoid* GetIndexData() const;
+
+    GLsizeiptr GetVertexDataSize() const;
+    GLsizeiptr GetIndexDataSize() const;
+
+private:
+    // Bits of the coarser neighbors of a patch: patches before and after it along x and z.
+    enum CoarseEdge
+    {
+        COARSE_NEGATIVE_X = 1,
+        COARSE_POSITIVE_X = 2,
+        COARSE_NEGATIVE_Z = 4,
+        COARSE_POSITIVE_Z = 8,
+        COARSE_EDGE_COMBINATIONS = 16
+    };
+
+    void AddIndexRange(int level, int coarseEdges);
+
+    int _patchesX;
+    int _patchesZ;
+    glm::vec2 _size;
+    float _lodDistance;
+    float _flatDistance;
+
+    std::vector<GLushort> _vertices;    // column and row of every vertex of the finest patch grid
+    std::vector<GLushort> _indices;
+
+    // First index and index count of each level and coarse edge combination.
+    std::vector<GLsizei> _rangeStarts;
+    std::vector<GLsizei> _rangeCounts;
+
+    std::vector<int> _levels;           // of each patch, row-major
+    std::vector<PatchDraw> _draws;
+    unsigned long long _triangleCount;
+};
@@ -0,0 +1,628 @@
+#include "Options.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "CpuWaveSolver.h"
+
+Options::Options() :
+        quadsX(40),
+        quadsZ(40),
+        meshSource(MeshSource::Indexed),
+        patchesX(16),
+        patchesZ(16),
+        indexLayout(IndexLayout::Triangles),
+        vertexFormat(VertexFormat::Float),
+        quadOrder(QuadOrder::RowMajor),
+        vertexCacheSize(32),
+        cullTileQuads(0),
+        emitterCount(0),
+        useEmitterTiles(true),
+        deformPath(DeformPath::Vertex),
+        useDamping(false),
+        dampingRate(1.0f),
+        simulationRate(240),
+        shading(Shading::Wireframe),
+        farFieldStart(0.0f),
+        farFieldEnd(0.0f),
+        instanceCount(0),
+        windowCount(1),
+        updateRate(0),
+        readbackMode(ReadbackMode::None),
+        printTimings(false),
+        showTimingOverlay(false),
+        benchmarkFrames(0),
+        benchmarkSweepFrames(0),
+        benchmarkFormat(BenchmarkFormat::Csv),
+        checkAllocations(false),
+        hotReload(false),
+        cpuBenchmarkFrames(0),
+        cpuSimulationFrames(0),
+        bakeFrames(0),
+        bakeEncoding(BakeEncoding::Float),
+        timeBlock(4),
+        threadCount(0),
+        usePersistentMapping(true)
+{ }
+
+// Parses a "<x>x<z>" pair such as "1024x1024".
+static bool ParseResolution(const char* argument, int& x, int& z)
+{
+    char trailing;
+    return std::sscanf(argument, "%dx%d%c", &x, &z, &trailing) == 2 && x > 0 && z > 0;
+}
+
+// Parses a "<start>,<end>" distance range such as "6,10".
+static bool ParseRange(const char* argument, float& start, float& end)
+{
+    char trailing;
+    return std::sscanf(argument, "%f,%f%c", &start, &end, &trailing) == 2 && start >= 0.0f && end > start;
+}
+
+bool ParseOptions(int argc, const char* argv[], Options& options)
+{
+    for (int index = 1; index < argc; ++index) {
+        const char* argument = argv[index];
+        const char* value = (index + 1 < argc) ? argv[index + 1] : nullptr;
+
+        if (std::strcmp(argument, "--quads") == 0 && value) {
+            if (!ParseResolution(value, options.quadsX, options.quadsZ)) {
+                std::cerr << "Invalid mesh resolution: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--mesh") == 0 && value) {
+            if (std::strcmp(value, "indexed") == 0) {
+                options.meshSource = MeshSource::Indexed;
+            }
+            else if (std::strcmp(value, "procedural") == 0) {
+                options.meshSource = MeshSource::Procedural;
+            }
+            else if (std::strcmp(value, "patches") == 0) {
+                options.meshSource = MeshSource::Patches;
+            }
+            else {
+                std::cerr << "Invalid mesh source: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--patches") == 0 && value) {
+            if (!ParseResolution(value, options.patchesX, options.patchesZ)) {
+                std::cerr << "Invalid patch count: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--layout") == 0 && value) {
+            if (std::strcmp(value, "triangles") == 0) {
+                options.indexLayout = IndexLayout::Triangles;
+            }
+            else if (std::strcmp(value, "strips") == 0) {
+                options.indexLayout = IndexLayout::Strips;
+            }
+            else {
+                std::cerr << "Invalid index layout: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--vertex-format") == 0 && value) {
+            if (std::strcmp(value, "float") == 0) {
+                options.vertexFormat = VertexFormat::Float;
+            }
+            else if (std::strcmp(value, "quantized") == 0) {
+                options.vertexFormat = VertexFormat::Quantized;
+            }
+            else {
+                std::cerr << "Invalid vertex format: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--reorder") == 0 && value) {
+            if (std::strcmp(value, "none") == 0) {
+                options.quadOrder = QuadOrder::RowMajor;
+            }
+            else if (std::strcmp(value, "bands") == 0) {
+                options.quadOrder = QuadOrder::Bands;
+            }
+            else if (std::strcmp(value, "hilbert") == 0) {
+                options.quadOrder = QuadOrder::Hilbert;
+            }
+            else {
+                std::cerr << "Invalid quad order: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--vertex-cache") == 0 && value) {
+            options.vertexCacheSize = std::atoi(value);
+            if (options.vertexCacheSize < 3) {
+                std::cerr << "Invalid vertex cache size: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--cull") == 0 && value) {
+            options.cullTileQuads = std::atoi(value);
+            if (options.cullTileQuads < 1) {
+                std::cerr << "Invalid culling tile size: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--emitters") == 0 && value) {
+            options.emitterCount = std::atoi(value);
+            if (options.emitterCount < 0) {
+                std::cerr << "Invalid emitter count: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--emitter-sum") == 0 && value) {
+            if (std::strcmp(value, "naive") == 0) {
+                options.useEmitterTiles = false;
+            }
+            else if (std::strcmp(value, "tiled") == 0) {
+                options.useEmitterTiles = true;
+            }
+            else {
+                std::cerr << "Invalid emitter summation: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--deform") == 0 && value) {
+            if (std::strcmp(value, "vertex") == 0) {
+                options.deformPath = DeformPath::Vertex;
+            }
+            else if (std::strcmp(value, "compute") == 0) {
+                options.deformPath = DeformPath::Compute;
+            }
+            else if (std::strcmp(value, "feedback") == 0) {
+                options.deformPath = DeformPath::TransformFeedback;
+            }
+            else if (std::strcmp(value, "cpu") == 0) {
+                options.deformPath = DeformPath::Cpu;
+            }
+            else if (std::strcmp(value, "tessellation") == 0) {
+                options.deformPath = DeformPath::Tessellation;
+            }
+            else if (std::strcmp(value, "simulation") == 0) {
+                options.deformPath = DeformPath::Simulation;
+            }
+            else {
+                std::cerr << "Invalid deformation path: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--damping") == 0 && value) {
+            options.dampingRate = static_cast<float>(std::atof(value));
+            if (options.dampingRate <= 0.0f) {
+                std::cerr << "Invalid damping rate: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            options.useDamping = true;
+            ++index;
+        }
+        else if (std::strcmp(argument, "--simulation-rate") == 0 && value) {
+            options.simulationRate = std::atoi(value);
+            if (options.simulationRate < 1) {
+                std::cerr << "Invalid simulation rate: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--shading") == 0 && value) {
+            if (std::strcmp(value, "wireframe") == 0) {
+                options.shading = Shading::Wireframe;
+            }
+            else if (std::strcmp(value, "lit") == 0) {
+                options.shading = Shading::Lit;
+            }
+            else {
+                std::cerr << "Invalid shading: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--far-field") == 0 && value) {
+            if (!ParseRange(value, options.farFieldStart, options.farFieldEnd)) {
+                std::cerr << "Invalid far field range: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--instances") == 0 && value) {
+            options.instanceCount = std::atoi(value);
+            if (options.instanceCount < 0) {
+                std::cerr << "Invalid instance count: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--windows") == 0 && value) {
+            options.windowCount = std::atoi(value);
+            if (options.windowCount < 1) {
+                std::cerr << "Invalid window count: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--stream") == 0 && value) {
+            if (std::strcmp(value, "persistent") == 0) {
+                options.usePersistentMapping = true;
+            }
+            else if (std::strcmp(value, "orphan") == 0) {
+                options.usePersistentMapping = false;
+            }
+            else {
+                std::cerr << "Invalid streaming mode: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--readback") == 0 && value) {
+            if (std::strcmp(value, "heights") == 0) {
+                options.readbackMode = ReadbackMode::Heights;
+            }
+            else if (std::strcmp(value, "pixels") == 0) {
+                options.readbackMode = ReadbackMode::Pixels;
+            }
+            else {
+                std::cerr << "Invalid readback: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--update-rate") == 0 && value) {
+            options.updateRate = std::atoi(value);
+            if (options.updateRate < 1) {
+                std::cerr << "Invalid update rate: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--timings") == 0) {
+            options.printTimings = true;
+        }
+        else if (std::strcmp(argument, "--overlay") == 0) {
+            options.showTimingOverlay = true;
+        }
+        else if (std::strcmp(argument, "--benchmark") == 0 && value) {
+            options.benchmarkFrames = std::atoi(value);
+            if (options.benchmarkFrames < 1) {
+                std::cerr << "Invalid benchmark frame count: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--benchmark-sweep") == 0 && value) {
+            options.benchmarkSweepFrames = std::atoi(value);
+            if (options.benchmarkSweepFrames < 1) {
+                std::cerr << "Invalid benchmark frame count: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--check-allocations") == 0) {
+            options.checkAllocations = true;
+        }
+        else if (std::strcmp(argument, "--benchmark-output") == 0 && value) {
+            options.benchmarkOutput = value;
+            ++index;
+        }
+        else if (std::strcmp(argument, "--benchmark-format") == 0 && value) {
+            if (std::strcmp(value, "csv") == 0) {
+                options.benchmarkFormat = BenchmarkFormat::Csv;
+            }
+            else if (std::strcmp(value, "json") == 0) {
+                options.benchmarkFormat = BenchmarkFormat::Json;
+            }
+            else {
+                std::cerr << "Invalid benchmark format: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--hot-reload") == 0) {
+            options.hotReload = true;
+        }
+        else if (std::strcmp(argument, "--shader-cache") == 0 && value) {
+            options.shaderCacheDirectory = value;
+            ++index;
+        }
+        else if (std::strcmp(argument, "--cpu-benchmark") == 0 && value) {
+            options.cpuBenchmarkFrames = std::atoi(value);
+            if (options.cpuBenchmarkFrames < 1) {
+                std::cerr << "Invalid benchmark frame count: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--cpu-simulation") == 0 && value) {
+            options.cpuSimulationFrames = std::atoi(value);
+            if (options.cpuSimulationFrames < 1) {
+                std::cerr << "Invalid simulation frame count: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--bake") == 0 && value) {
+            options.bakeFrames = std::atoi(value);
+            if (options.bakeFrames < 1) {
+                std::cerr << "Invalid bake frame count: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--bake-output") == 0 && value) {
+            options.bakeOutput = value;
+            ++index;
+        }
+        else if (std::strcmp(argument, "--bake-format") == 0 && value) {
+            if (std::strcmp(value, "float") == 0) {
+                options.bakeEncoding = BakeEncoding::Float;
+            }
+            else if (std::strcmp(value, "half") == 0) {
+                options.bakeEncoding = BakeEncoding::Half;
+            }
+            else {
+                std::cerr << "Invalid bake format: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--play") == 0 && value) {
+            options.playbackInput = value;
+            ++index;
+        }
+        else if (std::strcmp(argument, "--time-block") == 0 && value) {
+            options.timeBlock = std::atoi(value);
+            if (options.timeBlock < 1 || options.timeBlock > CpuWaveSolver::MAX_TIME_BLOCK) {
+                std::cerr << "Invalid time block: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else if (std::strcmp(argument, "--threads") == 0 && value) {
+            options.threadCount = std::atoi(value);
+            if (options.threadCount < 1) {
+                std::cerr << "Invalid thread count: " << value << std::endl;
+                PrintUsage(argv[0]);
+                return false;
+            }
+            ++index;
+        }
+        else {
+            std::cerr << "Unknown argument: " << argument << std::endl;
+            PrintUsage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options.emitterCount > 0 && options.meshSource != MeshSource::Indexed) {
+        std::cerr << "--emitters needs the indexed mesh" << std::endl;
+        return false;
+    }
+    if (options.deformPath != DeformPath::Vertex && (options.meshSource != MeshSource::Indexed || options.emitterCount > 0)) {
+        std::cerr << "--deform compute, feedback, cpu, tessellation and simulation need the indexed mesh and the single ripple" << std::endl;
+        return false;
+    }
+    if (options.meshSource == MeshSource::Patches && (options.emitterCount > 0 || options.deformPath != DeformPath::Vertex)) {
+        std::cerr << "--mesh patches needs the single ripple and --deform vertex" << std::endl;
+        return false;
+    }
+    if (options.cullTileQuads > 0
+            && (options.meshSource != MeshSource::Indexed || options.deformPath == DeformPath::Cpu
+                || options.deformPath == DeformPath::Simulation || options.quadOrder != QuadOrder::RowMajor)) {
+        std::cerr << "--cull needs the indexed mesh, a deformation path other than cpu and simulation, and no --reorder" << std::endl;
+        return false;
+    }
+    if (options.instanceCount > 0
+            && (options.meshSource != MeshSource::Indexed || options.emitterCount > 0 || options.deformPath != DeformPath::Vertex
+                || options.vertexFormat != VertexFormat::Float || options.cullTileQuads > 0)) {
+        std::cerr << "--instances needs the indexed float mesh, the single ripple, --deform vertex and no --cull" << std::endl;
+        return false;
+    }
+    if (options.vertexFormat == VertexFormat::Quantized
+            && (options.meshSource != MeshSource::Indexed || options.emitterCount > 0 || options.deformPath != DeformPath::Vertex)) {
+        std::cerr << "--vertex-format quantized needs the indexed mesh, the single ripple and --deform vertex" << std::endl;
+        return false;
+    }
+    if (options.useDamping
+            && (options.meshSource != MeshSource::Indexed || options.emitterCount > 0 || options.deformPath != DeformPath::Vertex
+                || options.instanceCount > 0)) {
+        std::cerr << "--damping needs the indexed mesh, the single ripple, --deform vertex and no --instances" << std::endl;
+        return false;
+    }
+    if (options.shading == Shading::Lit
+            && (options.meshSource == MeshSource::Procedural || options.emitterCount > 0 || options.instanceCount > 0
+                || (options.deformPath != DeformPath::Vertex && options.deformPath != DeformPath::Compute
+                    && options.deformPath != DeformPath::TransformFeedback && options.deformPath != DeformPath::Simulation))) {
+        std::cerr << "--shading lit needs the indexed mesh or patches, the single ripple, --deform vertex, compute,"
+                  << " feedback or simulation and no --instances" << std::endl;
+        return false;
+    }
+    if (options.farFieldEnd > 0.0f && (options.shading != Shading::Lit || options.deformPath != DeformPath::Vertex)) {
+        std::cerr << "--far-field needs --shading lit and --deform vertex" << std::endl;
+        return false;
+    }
+    if (options.bakeFrames > 0
+            && (options.bakeOutput.empty() || options.updateRate > 0 || options.benchmarkFrames > 0 || !options.playbackInput.empty()
+                || (options.deformPath != DeformPath::Compute && options.deformPath != DeformPath::TransformFeedback
+                    && options.deformPath != DeformPath::Simulation))) {
+        std::cerr << "--bake needs --bake-output, --deform compute, feedback or simulation and no --update-rate,"
+                  << " --benchmark or --play" << std::endl;
+        return false;
+    }
+    if (options.readbackMode == ReadbackMode::Heights
+            && options.deformPath != DeformPath::Compute && options.deformPath != DeformPath::TransformFeedback
+            && options.deformPath != DeformPath::Simulation) {
+        std::cerr << "--readback heights needs --deform compute, feedback or simulation" << std::endl;
+        return false;
+    }
+    if (!options.playbackInput.empty() && options.deformPath != DeformPath::Simulation) {
+        std::cerr << "--play needs --deform simulation" << std::endl;
+        return false;
+    }
+    if (options.windowCount > 1
+            && (options.meshSource != MeshSource::Indexed || options.emitterCount > 0 || options.deformPath != DeformPath::Vertex
+                || options.instanceCount > 0 || options.cullTileQuads > 0 || options.farFieldEnd > 0.0f || options.hotReload
+                || options.useDamping || options.benchmarkFrames > 0 || options.bakeFrames > 0)) {
+        std::cerr << "--windows needs the indexed mesh, the single ripple, --deform vertex and no --instances, --cull,"
+                  << " --far-field, --hot-reload, --damping, --benchmark or --bake" << std::endl;
+        return false;
+    }
+    if (options.checkAllocations && options.benchmarkFrames == 0) {
+        std::cerr << "--check-allocations needs --benchmark" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void PrintUsage(const char* programName)
+{
+    std::cerr << "Usage: " << programName << " [options]\n"
+              << "  --quads <x>x<z>    mesh resolution in quads (default 40x40)\n"
+              << "  --mesh <source>    indexed (default), procedural (no vertex/index buffers)\n"
+              << "                     or patches (level of detail patches picked from the camera distance)\n"
+              << "  --patches <x>x<z>  patches along x and z for --mesh patches (default 16x16)\n"
+              << "  --layout <layout>  triangles (default) or strips (one strip per row, primitive restart)\n"
+              << "  --vertex-format <f> float (default, 12 bytes per vertex) or quantized (16-bit column and row, 4 bytes)\n"
+              << "  --reorder <order>  quad order for the vertex cache: none (default), bands or hilbert\n"
+              << "  --vertex-cache <n> post-transform cache size targeted by --reorder and the ACMR report (default 32)\n"
+              << "  --cull <n>         split the grid into n x n quad tiles and skip those outside the view frustum\n"
+              << "  --emitters <n>     sum n ripple emitters from a shader storage buffer (OpenGL 4.3)\n"
+              << "  --emitter-sum <s>  tiled (default, skip emitters that can't reach a tile) or naive\n"
+              << "  --deform <path>    vertex (default), compute (deform once per frame into a buffer, OpenGL 4.3)\n"
+              << "                     or feedback (same, captured from a vertex shader with transform feedback)\n"
+              << "                     or cpu (deformed by the SIMD CPU deformer and streamed to the GPU)\n"
+              << "                     or tessellation (coarse quads tessellated by screen size and curvature, OpenGL 4.0)\n"
+              << "                     or simulation (damped wave equation on the GPU, click to drop, OpenGL 4.3)\n"
+              << "  --simulation-rate <hz> wave equation steps per second for --deform simulation (default 240)\n"
+              << "  --damping <rate>   fade the ripple out by exp(-rate * distance); D switches it on and off\n"
+              << "  --shading <s>      wireframe (default) or lit (filled, lit with the ripple's normals)\n"
+              << "  --far-field <a>,<b> fade the lit ripple's geometry into per-pixel normals from a to b camera distance\n"
+              << "  --instances <n>    draw n independent surfaces (transform, phase, color) with one instanced draw\n"
+              << "  --windows <n>      draw in n windows, each from its own thread, sharing the buffers and programs\n"
+              << "  --stream <mode>    how --deform cpu uploads: persistent (default, mapped ring of 3, OpenGL 4.4)\n"
+              << "                     or orphan (glBufferData(nullptr) + glBufferSubData)\n"
+              << "  --update-rate <hz> step the simulation on its own thread at a fixed rate (default: once per frame)\n"
+              << "  --readback <r>     read heights (--deform compute, feedback or simulation) or pixels back every frame,\n"
+              << "                     asynchronously, and report their range or checksum with --timings\n"
+              << "  --timings          print CPU (poll, render, swap) and GPU frame times, min/avg/p99, every second\n"
+              << "  --overlay          show the same frame times in the window title\n"
+              << "  --benchmark <n>    render n frames offscreen without vsync, write the result and exit\n"
+              << "  --benchmark-sweep <n> run --benchmark <n> over a set of resolutions, layouts, formats and paths\n"
+              << "  --benchmark-output <file> append benchmark results to a file (default the console)\n"
+              << "  --benchmark-format <f> csv (default) or json (one object per line)\n"
+              << "  --check-allocations fail --benchmark if its timed frames allocate from the heap\n"
+              << "  --hot-reload       rebuild the program in the background when its shader files change\n"
+              << "  --shader-cache <dir> keep linked program binaries in dir (default none)\n"
+              << "  --cpu-benchmark <n> time n frames of the SIMD CPU deformer for every kernel, without a window\n"
+              << "  --cpu-simulation <n> run n frames of --deform simulation on the CPU wave solver, without a window\n"
+              << "  --bake <n>         render n frames of --deform compute, feedback or simulation at 60 frames per second,\n"
+              << "                     write their heights to --bake-output and exit\n"
+              << "  --bake-output <file> write the heights of every --bake or --cpu-simulation frame to a bake file\n"
+              << "  --bake-format <f>  float (default) or half\n"
+              << "  --play <file>      draw a bake file with --deform simulation, instead of running the wave equation\n"
+              << "  --time-block <n>   wave equation steps per pass over the grid for --cpu-simulation, 1 to 8 (default 4)\n"
+              << "  --threads <n>      CPU deformer and wave solver threads (default one per hardware thread)\n"
+              << std::flush;
+}
+
+const char* GetOptionName(MeshSource meshSource)
+{
+    switch (meshSource) {
+        case MeshSource::Procedural :
+            return "procedural";
+        case MeshSource::Patches :
+            return "patches";
+        default :
+            return "indexed";
+    }
+}
+
+const char* GetOptionName(IndexLayout indexLayout)
+{
+    switch (indexLayout) {
+        case IndexLayout::Strips :
+            return "strips";
+        case IndexLayout::Patches :
+            return "patches";
+        default :
+            return "triangles";
+    }
+}
+
+const char* GetOptionName(VertexFormat vertexFormat)
+{
+    return vertexFormat == VertexFormat::Quantized ? "quantized" : "float";
+}
+
+const char* GetOptionName(DeformPath deformPath)
+{
+    switch (deformPath) {
+        case DeformPath::Compute :
+            return "compute";
+        case DeformPath::TransformFeedback :
+            return "feedback";
+        case DeformPath::Cpu :
+            return "cpu";
+        case DeformPath::Tessellation :
+            return "tessellation";
+        case DeformPath::Simulation :
+            return "simulation";
+        default :
+            return "vertex";
+    }
+}
+
+const char* GetOptionName(Shading shading)
+{
+    return shading == Shading::Lit ? "lit" : "wireframe";
+}
+
+const char* GetOptionName(BakeEncoding bakeEncoding)
+{
+    switch (bakeEncoding) {
+        case BakeEncoding::Half :
+            return "half";
+        default :
+            return "float";
+    }
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <string>
+
+#include "BakeFormat.h"
+#include "GridMesh.h"
+
+// Where the grid geometry comes from.
+enum class MeshSource
+{
+    Indexed,    // vertex and index buffers generated by GridMesh
+    Procedural, // no buffers; positions are rebuilt from gl_VertexID/gl_InstanceID
+    Patches     // a large field of LodPatches, each at a level of detail picked from the camera distance
+};
+
+// Where the ripple displacement is evaluated.
+enum class DeformPath
+{
+    Vertex,             // in the vertex shader of every pass
+    Compute,            // once per frame by a compute shader, into a buffer the passes draw from
+    TransformFeedback,  // once per frame by a vertex shader captured with transform feedback
+    Cpu,                // once per frame by the CPU deformer, streamed into a vertex buffer
+    Tessellation,       // after tessellating the grid quads as patches, in the evaluation shader
+    Simulation          // not a closed-form ripple: a damped wave equation stepped on the GPU, with drops
+};
+
+// How the surface is drawn.
+enum class Shading
+{
+    Wireframe,  // the edges of the grid in its flat color
+    Lit         // filled, depth tested, with a directional light on the ripple's normals
+};
+
+// What is read back from the GPU every frame, through AsyncReadback.
+enum class ReadbackMode
+{
+    None,
+    Heights,    // the deformed heights, as a collision query would
+    Pixels      // the rendered frame, as an image diff would
+};
+
+// File format of benchmark results.
+enum class BenchmarkFormat
+{
+    Csv,    // a header line, then one line per run
+    Json    // one JSON object per line and run
+};
+
+/**
+ * Runtime settings, parsed from the command line.
+ */
+struct Options
+{
+    Options();
+
+    // Mesh resolution in quads along x and z.
+    int quadsX;
+    int quadsZ;
+
+    MeshSource meshSource;
+
+    // Number of patches along x and z used by MeshSource::Patches.
+    int patchesX;
+    int patchesZ;
+
+    // Index layout used by MeshSource::Indexed.
+    IndexLayout indexLayout;
+
+    // Vertex format of the grid buffer used by MeshSource::Indexed.
+    VertexFormat vertexFormat;
+
+    // Quad order of the generated indices, and the post-transform vertex cache size it targets. The
+    // cache size is also used to report the ACMR of the index buffer.
+    QuadOrder quadOrder;
+    int vertexCacheSize;
+
+    // Quads along the side of a frustum culling tile; 0 draws the whole grid every frame.
+    int cullTileQuads;
+
+    // Number of ripple emitters summed per vertex; 0 draws the single ripple around the wave center.
+    int emitterCount;
+
+    // Sum only the emitters reaching each vertex's tile, rather than every emitter.
+    bool useEmitterTiles;
+
+    DeformPath deformPath;
+
+    // Fade the single ripple out with the distance from its center, by exp(-dampingRate * distance).
+    bool useDamping;
+    float dampingRate;
+
+    // Steps per second of simulation time of DeformPath::Simulation; each moves waves half a grid point.
+    int simulationRate;
+
+    Shading shading;
+
+    // Camera distances over which the lit ripple's displacement fades into per-pixel normals; past
+    // farFieldEnd the surface is flat. A farFieldEnd of 0 displaces the whole surface.
+    float farFieldStart;
+    float farFieldEnd;
+
+    // Number of independent surfaces drawn with one instanced draw; 0 draws the single surface.
+    int instanceCount;
+
+    // Windows drawing the surface, each from its own thread and angle, all sharing one set of GL objects.
+    int windowCount;
+
+    // Steps per second of the simulation update thread; 0 updates on the render thread, once per frame.
+    int updateRate;
+
+    ReadbackMode readbackMode;
+
+    // Print rolling frame timings to the console, and show them in the window title.
+    bool printTimings;
+    bool showTimingOverlay;
+
+    // Frames to render offscreen, without vsync, before writing a benchmark result and exiting; 0 runs
+    // normally. A sweep runs such a benchmark for each of a set of configurations instead.
+    int benchmarkFrames;
+    int benchmarkSweepFrames;
+
+    // Where benchmark results are appended, and how; an empty path writes them to the console.
+    std::string benchmarkOutput;
+    BenchmarkFormat benchmarkFormat;
+
+    // Count the heap allocations of the benchmark's timed frames, and fail it if there are any.
+    bool checkAllocations;
+
+    // Rebuild the program in the background when its shader files change, and swap it in once linked.
+    bool hotReload;
+
+    // Directory of the program binary cache; empty, the default, compiles every program on every run.
+    std::string shaderCacheDirectory;
+
+    // Frames to time the CPU reference deformer over without opening a window; 0 runs normally.
+    int cpuBenchmarkFrames;
+
+    // Frames of --deform simulation to run on the CPU wave solver without opening a window, at 60 frames
+    // per second and --simulation-rate steps per second; 0 runs normally.
+    int cpuSimulationFrames;
+
+    // Frames of --deform compute, feedback or simulation to render on a 60 frames per second clock, with
+    // their heights read back from the GPU, before exiting; 0 runs normally.
+    int bakeFrames;
+
+    // Where the heights of every --bake or --cpu-simulation frame are written as a bake file, and how.
+    // An empty path writes none.
+    std::string bakeOutput;
+    BakeEncoding bakeEncoding;
+
+    // A bake file to draw, in place of the --deform simulation wave equation that would otherwise run.
+    std::string playbackInput;
+
+    // Steps the CPU wave solver runs per pass over the grid, 1 to CpuWaveSolver::MAX_TIME_BLOCK.
+    int timeBlock;
+
+    // Threads used by the CPU deformer and the CPU wave solver; 0 means one per hardware thread.
+    int threadCount;
+
+    // Stream DeformPath::Cpu vertices through a persistently mapped ring buffer rather than by orphaning.
+    bool usePersistentMapping;
+};
+
+// Returns false if the arguments couldn't be parsed; the usage has been printed in that case.
+bool ParseOptions(int argc, const char* argv[], Options& options);
+
+void PrintUsage(const char* programName);
+
+// The command line names of the settings, as taken by ParseOptions.
+const char* GetOptionName(MeshSource meshSource);
+const char* GetOptionName(IndexLayout indexLayout);
+const char* GetOptionName(VertexFormat vertexFormat);
+const char* GetOptionName(DeformPath deformPath);
+const char* GetOptionName(Shading shading);
+const char* GetOptionName(BakeEncoding bakeEncoding);
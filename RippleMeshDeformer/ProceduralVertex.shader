@@ -0,0 +1,31 @@
+#version 330 core
+
+// Index-free version of Vertex.shader: no vertex or index buffers are bound. The grid is drawn as one
+// triangle strip per row of quads, with gl_InstanceID selecting the row and gl_VertexID walking the
+// strip, alternating between the row's near (even IDs) and far (odd IDs) edge.
+
+uniform ivec2 gridQuads;    // number of quads along x and z
+uniform vec2 gridSize;      // size of the plane in world space
+
+layout (std140) uniform FrameUniforms  // filled from the FrameUniforms struct in FrameUniforms.h
+{
+    mat4 modelViewProjectMatrix;
+    vec4 newColor;
+    vec2 waveCenter;
+    float waveTime;
+    float amplitude;
+    float frequency;
+};
+
+const float PI = 3.14159;
+
+void main()
+{
+    ivec2 gridPoint = ivec2(gl_VertexID >> 1, gl_InstanceID + (gl_VertexID & 1));
+    vec2 position = (vec2(gridPoint) / vec2(gridQuads) * 2 - 1) * gridSize * 0.5;
+    vec3 vertex = vec3(position.x, 0, position.y);
+
+    float distance = length(vertex.xz - waveCenter);
+    float y = amplitude * sin(-PI * distance * frequency + waveTime);
+    gl_Position = modelViewProjectMatrix * vec4(vertex.x, y, vertex.z, 1);
+}
@@ -0,0 +1,191 @@
+#include "ProgramBinaryCache.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Start of every cache file, before the binary format, the driver strings' length and the binary's length.
+static const uint32_t FILE_MAGIC = 0x42504D52;  // "RMPB"
+
+// Larger binaries read from a cache file are taken for a damaged file; drivers' are well under a megabyte.
+static const uint32_t MAX_BINARY_BYTES = 64 * 1024 * 1024;
+
+// Creates a directory, which may already exist.
+static bool MakeDirectory(const std::string& directory)
+{
+#if defined(_WIN32)
+    return _mkdir(directory.c_str()) == 0 || errno == EEXIST;
+#else
+    return mkdir(directory.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+// 64-bit FNV-1a.
+static uint64_t Hash(const std::string& text, uint64_t hash = 14695981039346656037ULL)
+{
+    for (size_t index = 0; index < text.size(); ++index) {
+        hash = (hash ^ static_cast<unsigned char>(text[index])) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static std::string GetString(GLenum name)
+{
+    const GLubyte* string = glGetString(name);
+    return string != nullptr ? reinterpret_cast<const char*>(string) : "";
+}
+
+ProgramBinaryCache::ProgramBinaryCache() :
+        _isEnabled(false),
+        _hitCount(0),
+        _missCount(0)
+{ }
+
+ProgramBinaryCache::~ProgramBinaryCache()
+{ }
+
+bool ProgramBinaryCache::Init(const std::string& directory)
+{
+    _isEnabled = false;
+
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    // Not an error: the driver just compiles every time.
+    if (formatCount == 0) {
+        return false;
+    }
+
+    if (!MakeDirectory(directory)) {
+        std::cerr << "ProgramBinaryCache::Init: Can't create " << directory << std::endl;
+        return false;
+    }
+
+    _directory = directory;
+    _driver = GetString(GL_VENDOR) + "\n" + GetString(GL_RENDERER) + "\n" + GetString(GL_VERSION);
+    _isEnabled = true;
+    return true;
+}
+
+bool ProgramBinaryCache::IsEnabled() const
+{
+    return _isEnabled;
+}
+
+std::string ProgramBinaryCache::MakeKey(const std::string& programSource) const
+{
+    std::ostringstream key;
+    key << std::hex;
+    key.width(16);
+    key.fill('0');
+    key << Hash(programSource, Hash(_driver));
+    return key.str();
+}
+
+bool ProgramBinaryCache::Load(const std::string& key, GLuint program)
+{
+    if (!_isEnabled) {
+        return false;
+    }
+
+    std::ifstream file(GetPath(key).c_str(), std::ios::binary | std::ios::ate);
+    const std::streamoff fileBytes = file ? static_cast<std::streamoff>(file.tellg()) : 0;
+    file.seekg(0);
+    uint32_t header[4] = { 0, 0, 0, 0 };
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != FILE_MAGIC) {
+        ++_missCount;
+        return false;
+    }
+
+    // Check the lengths against the file before allocating for them, so a damaged file is only a miss.
+    const std::streamoff remainingBytes = fileBytes - static_cast<std::streamoff>(sizeof(header));
+    if (header[2] != _driver.size() || header[3] == 0 || header[3] > MAX_BINARY_BYTES
+            || static_cast<std::streamoff>(header[2]) + header[3] != remainingBytes) {
+        ++_missCount;
+        return false;
+    }
+
+    std::string driver(header[2], '\0');
+    std::vector<char> binary(header[3]);
+    if (!file.read(&driver[0], driver.size()) || driver != _driver || !file.read(binary.data(), binary.size())) {
+        ++_missCount;
+        return false;
+    }
+
+    glProgramBinary(program, header[1], binary.data(), static_cast<GLsizei>(binary.size()));
+
+    GLint didLink = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &didLink);
+    if (didLink != GL_TRUE) {
+        ++_missCount;
+        return false;
+    }
+
+    ++_hitCount;
+    return true;
+}
+
+void ProgramBinaryCache::Store(const std::string& key, GLuint program)
+{
+    if (!_isEnabled) {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    // Write a temporary file and move it into place, so that a concurrent run never reads half a binary.
+    const std::string path = GetPath(key);
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath.c_str(), std::ios::binary | std::ios::trunc);
+        const uint32_t header[4] = { FILE_MAGIC, format, static_cast<uint32_t>(_driver.size()), static_cast<uint32_t>(length) };
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        file.write(_driver.data(), _driver.size());
+        file.write(binary.data(), length);
+        if (!file) {
+            std::cerr << "ProgramBinaryCache::Store: Can't write " << temporaryPath << std::endl;
+            return;
+        }
+    }
+
+#if defined(_WIN32)
+    // Only POSIX rename replaces an existing file.
+    std::remove(path.c_str());
+#endif
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "ProgramBinaryCache::Store: Can't rename " << temporaryPath << std::endl;
+        std::remove(temporaryPath.c_str());
+    }
+}
+
+unsigned int ProgramBinaryCache::GetHitCount() const
+{
+    return _hitCount;
+}
+
+unsigned int ProgramBinaryCache::GetMissCount() const
+{
+    return _missCount;
+}
+
+std::string ProgramBinaryCache::GetPath(const std::string& key) const
+{
+    return _directory + "/" + key + ".bin";
+}
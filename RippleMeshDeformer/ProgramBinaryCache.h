@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+/**
+ * A directory of linked program binaries, so that a program only goes through the driver's compiler
+ * the first time its sources are seen.
+ *
+ * Each binary is kept in a file named after a 64-bit hash of the program's sources and of the vendor,
+ * renderer and version strings of the driver, so that changing either misses. A file also records the
+ * driver strings it was written with and is only used when they match. Drivers can still reject a
+ * binary (glProgramBinary leaves the program unlinked); callers then compile as usual and store the
+ * new binary over the old one.
+ */
+class ProgramBinaryCache final
+{
+public:
+    ProgramBinaryCache();
+
+    ProgramBinaryCache(const ProgramBinaryCache& rhs) = delete;
+    ProgramBinaryCache(ProgramBinaryCache&& rhs) = delete;
+
+    ProgramBinaryCache& operator=(const ProgramBinaryCache& rhs) = delete;
+    ProgramBinaryCache& operator=(ProgramBinaryCache&& rhs) = delete;
+
+    ~ProgramBinaryCache();
+
+    // Needs a current context. Returns false, and leaves the cache disabled, if the driver offers no
+    // program binary formats, which isn't reported, or the directory can't be created.
+    bool Init(const std::string& directory);
+
+    bool IsEnabled() const;
+
+    // The key of a program, from everything that goes into linking it.
+    std::string MakeKey(const std::string& programSource) const;
+
+    // Restores a program from its binary; returns false, with the program unlinked, on a miss.
+    bool Load(const std::string& key, GLuint program);
+
+    // Writes the binary of a linked program, which should have GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+    void Store(const std::string& key, GLuint program);
+
+    unsigned int GetHitCount() const;
+    unsigned int GetMissCount() const;
+
+private:
+    std::string GetPath(const std::string& key) const;
+
+    bool _isEnabled;
+    std::string _directory;
+    std::string _driver;    // vendor, renderer and version, one per line
+
+    // Programs are loaded on the ProgramBuilder thread too.
+    std::atomic<unsigned int> _hitCount;
+    std::atomic<unsigned int> _missCount;
+};
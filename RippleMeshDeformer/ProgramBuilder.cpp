@@ -0,0 +1,143 @@
+#include "ProgramBuilder.h"
+
+#include <iostream>
+
+ProgramBuilder::ProgramBuilder() :
+        _window(nullptr),
+        _hasBuild(false),
+        _generation(0),
+        _fence(nullptr),
+        _isBuilding(false),
+        _isStopping(false)
+{ }
+
+ProgramBuilder::~ProgramBuilder()
+{
+    Destroy();
+}
+
+bool ProgramBuilder::Create(GLFWwindow* shareWindow)
+{
+    // The hints of the main window, such as the context version, still apply; it is just never shown.
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    _window = glfwCreateWindow(1, 1, "Program builder", nullptr, shareWindow);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (_window == nullptr) {
+        std::cerr << "ProgramBuilder::Create: Can't open a window sharing the main context" << std::endl;
+        return false;
+    }
+
+    _isStopping = false;
+    _thread = std::thread(&ProgramBuilder::Run, this);
+    return true;
+}
+
+void ProgramBuilder::Build(const std::vector<ShaderStage>& stages, const ShaderDefines& defines)
+{
+    std::unique_ptr<GLSLProgram> superseded;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stages = stages;
+        _defines = defines;
+        _hasBuild = true;
+        ++_generation;
+        _isBuilding = true;
+
+        // The objects are shared, so this context can delete what the thread's built.
+        superseded = std::move(_program);
+        if (_fence != nullptr) {
+            glDeleteSync(_fence);
+            _fence = nullptr;
+        }
+    }
+    _buildAvailable.notify_one();
+}
+
+bool ProgramBuilder::IsBuilding() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _isBuilding;
+}
+
+bool ProgramBuilder::TakeProgram(std::unique_ptr<GLSLProgram>& program)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_program || glClientWaitSync(_fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+
+    glDeleteSync(_fence);
+    _fence = nullptr;
+    program = std::move(_program);
+    _isBuilding = false;
+    return true;
+}
+
+void ProgramBuilder::Destroy()
+{
+    if (_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _isStopping = true;
+        }
+        _buildAvailable.notify_one();
+        _thread.join();
+    }
+    if (_window != nullptr) {
+        glfwDestroyWindow(_window);
+        _window = nullptr;
+    }
+    _isBuilding = false;
+}
+
+void ProgramBuilder::Run()
+{
+    // A context is current on one thread at a time; this one stays on this thread until it stops.
+    glfwMakeContextCurrent(_window);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+        _buildAvailable.wait(lock, [this] { return _hasBuild || _isStopping; });
+        if (_isStopping) {
+            break;
+        }
+        const std::vector<ShaderStage> stages = _stages;
+        const ShaderDefines defines = _defines;
+        const unsigned long long generation = _generation;
+        _hasBuild = false;
+        lock.unlock();
+
+        std::unique_ptr<GLSLProgram> program(new GLSLProgram());
+        for (size_t index = 0; index < stages.size(); ++index) {
+            program->AddShaderFromFile(stages[index].type, stages[index].path, defines);
+        }
+        program->CreateAndLinkProgram();
+
+        // Flushed, so the fence signals without this context ever issuing another command.
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+
+        lock.lock();
+        if (generation == _generation && !_isStopping) {
+            _program = std::move(program);
+            _fence = fence;
+        }
+        else {
+            glDeleteSync(fence);
+            lock.unlock();
+            program.reset();
+            lock.lock();
+        }
+    }
+
+    // Objects left over are deleted in this context, before it is released.
+    _program.reset();
+    if (_fence != nullptr) {
+        glDeleteSync(_fence);
+        _fence = nullptr;
+    }
+    lock.unlock();
+
+    glFinish();
+    glfwMakeContextCurrent(nullptr);
+}
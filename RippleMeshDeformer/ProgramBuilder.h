@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+// GLFW: A simple API for creating windows, contexts and surfaces, and receiving input and events
+#include <GLFW/glfw3.h>
+
+#include "GLSLProgram.h"
+#include "ShaderVariants.h"
+
+/**
+ * Builds programs on a thread of its own, so the render thread never waits for one.
+ *
+ * The thread has the context of a hidden window that shares objects with the main one. Reading the
+ * shader files, compiling, linking and storing the binary in a ProgramBinaryCache all happen there,
+ * whether or not the driver compiles in the background by itself. A finished program comes with a
+ * fence placed after the commands that built it, and is only handed over once the fence has signaled,
+ * so the main context never sees a program whose link it can't see the end of.
+ */
+class ProgramBuilder final
+{
+public:
+    ProgramBuilder();
+
+    ProgramBuilder(const ProgramBuilder& rhs) = delete;
+    ProgramBuilder(ProgramBuilder&& rhs) = delete;
+
+    ProgramBuilder& operator=(const ProgramBuilder& rhs) = delete;
+    ProgramBuilder& operator=(ProgramBuilder&& rhs) = delete;
+
+    ~ProgramBuilder();
+
+    // Opens the hidden window, whose context shares objects with shareWindow's, and starts its thread.
+    // Main thread only, like every GLFW window function.
+    bool Create(GLFWwindow* shareWindow);
+
+    // Starts building a program from the files of its stages. A build started earlier and not yet taken
+    // is superseded: its program is dropped once it is done.
+    void Build(const std::vector<ShaderStage>& stages, const ShaderDefines& defines);
+
+    // True from Build() until TakeProgram() has handed over its program.
+    bool IsBuilding() const;
+
+    // Hands over the program of the latest build without waiting, once it is done and its fence has
+    // signaled; returns false until then. A program that failed to build isn't created.
+    bool TakeProgram(std::unique_ptr<GLSLProgram>& program);
+
+    // Stops the thread, dropping any build, and destroys the window. Main thread only.
+    void Destroy();
+
+private:
+    void Run();
+
+    GLFWwindow* _window;
+    std::thread _thread;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _buildAvailable;
+
+    // The latest build asked for, and whether the thread has yet to start it.
+    std::vector<ShaderStage> _stages;
+    ShaderDefines _defines;
+    bool _hasBuild;
+    unsigned long long _generation;     // bumped for every Build() so the thread can tell old builds from new
+
+    // The finished program of the latest build, and its fence.
+    std::unique_ptr<GLSLProgram> _program;
+    GLsync _fence;
+
+    bool _isBuilding;
+    bool _isStopping;
+};
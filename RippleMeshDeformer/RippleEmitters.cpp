@@ -0,0 +1,148 @@
+#include "RippleEmitters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+const float RippleEmitters::CUTOFF_AMPLITUDE = 0.001f;
+
+// Distance past which the emitter's envelope falls below the cutoff amplitude.
+static float InfluenceRadius(const RippleEmitter& emitter)
+{
+    if (emitter.decay <= 0.0f) {
+        return std::numeric_limits<float>::max();
+    }
+    return std::max(0.0f, std::log(std::abs(emitter.amplitude) / RippleEmitters::CUTOFF_AMPLITUDE) / emitter.decay);
+}
+
+// Uploads a vector to a shader storage buffer, creating the buffer the first time.
+template <typename T>
+static void UploadStorageBuffer(GLuint& bufferId, GLuint bindingPoint, const std::vector<T>& data)
+{
+    if (bufferId == 0) {
+        glGenBuffers(1, &bufferId);
+    }
+
+    // An empty buffer can't be bound, so always store at least one element.
+    const T empty = T();
+    const GLvoid* source = data.empty() ? &empty : static_cast<const GLvoid*>(data.data());
+    const GLsizeiptr size = static_cast<GLsizeiptr>(std::max<size_t>(data.size(), 1) * sizeof(T));
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferId);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, size, source, GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingPoint, bufferId);
+}
+
+RippleEmitters::RippleEmitters() :
+        _emittersBufferId(0),
+        _tilesBufferId(0),
+        _tileIndicesBufferId(0)
+{ }
+
+RippleEmitters::~RippleEmitters()
+{
+    Delete();
+}
+
+void RippleEmitters::GenerateRandom(int count, float sizeX, float sizeZ, unsigned int seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> x(-sizeX / 2.0f, sizeX / 2.0f);
+    std::uniform_real_distribution<float> z(-sizeZ / 2.0f, sizeZ / 2.0f);
+    std::uniform_real_distribution<float> amplitude(0.02f, 0.08f);
+    std::uniform_real_distribution<float> frequency(2.0f, 8.0f);
+    std::uniform_real_distribution<float> phase(0.0f, 6.2831853f);
+    std::uniform_real_distribution<float> decay(2.0f, 8.0f);
+
+    Clear();
+    _emitters.reserve(count);
+    for (int index = 0; index < count; ++index) {
+        RippleEmitter emitter = RippleEmitter();
+        emitter.center = glm::vec2(x(generator), z(generator));
+        emitter.amplitude = amplitude(generator);
+        emitter.frequency = frequency(generator);
+        emitter.phase = phase(generator);
+        emitter.decay = decay(generator);
+        Add(emitter);
+    }
+}
+
+void RippleEmitters::Add(const RippleEmitter& emitter)
+{
+    _emitters.push_back(emitter);
+    _emitters.back().radius = InfluenceRadius(emitter);
+}
+
+void RippleEmitters::Clear()
+{
+    _emitters.clear();
+    _tiles.clear();
+    _tileIndices.clear();
+}
+
+void RippleEmitters::BuildTiles(int tilesX, int tilesZ, float sizeX, float sizeZ)
+{
+    _tiles.assign(static_cast<size_t>(tilesX) * tilesZ, glm::uvec2(0, 0));
+    _tileIndices.clear();
+
+    const float tileSizeX = sizeX / tilesX;
+    const float tileSizeZ = sizeZ / tilesZ;
+
+    for (int tileZ = 0; tileZ < tilesZ; ++tileZ) {
+        for (int tileX = 0; tileX < tilesX; ++tileX) {
+            const float minX = -sizeX / 2.0f + tileX * tileSizeX;
+            const float minZ = -sizeZ / 2.0f + tileZ * tileSizeZ;
+
+            glm::uvec2& tile = _tiles[tileZ * tilesX + tileX];
+            tile.x = static_cast<GLuint>(_tileIndices.size());
+
+            // Keep an emitter if its radius reaches the closest point of the tile's rectangle. Vertices on
+            // a tile edge belong to a single tile, and any emitter reaching them reaches that tile too.
+            for (size_t index = 0; index < _emitters.size(); ++index) {
+                const RippleEmitter& emitter = _emitters[index];
+                const float dx = emitter.center.x - std::max(minX, std::min(emitter.center.x, minX + tileSizeX));
+                const float dz = emitter.center.y - std::max(minZ, std::min(emitter.center.y, minZ + tileSizeZ));
+                if (dx * dx + dz * dz <= emitter.radius * emitter.radius) {
+                    _tileIndices.push_back(static_cast<GLuint>(index));
+                }
+            }
+
+            tile.y = static_cast<GLuint>(_tileIndices.size()) - tile.x;
+        }
+    }
+}
+
+void RippleEmitters::Upload()
+{
+    UploadStorageBuffer(_emittersBufferId, EMITTERS_BINDING, _emitters);
+    UploadStorageBuffer(_tilesBufferId, EMITTER_TILES_BINDING, _tiles);
+    UploadStorageBuffer(_tileIndicesBufferId, EMITTER_TILE_INDICES_BINDING, _tileIndices);
+}
+
+void RippleEmitters::Delete()
+{
+    if (_emittersBufferId == 0) {
+        return;
+    }
+
+    glDeleteBuffers(1, &_emittersBufferId);
+    glDeleteBuffers(1, &_tilesBufferId);
+    glDeleteBuffers(1, &_tileIndicesBufferId);
+
+    _emittersBufferId = 0;
+    _tilesBufferId = 0;
+    _tileIndicesBufferId = 0;
+}
+
+const std::vector<RippleEmitter>& RippleEmitters::GetEmitters() const
+{
+    return _emitters;
+}
+
+double RippleEmitters::GetAverageEmittersPerTile() const
+{
+    return _tiles.empty() ? 0.0 : static_cast<double>(_tileIndices.size()) / _tiles.size();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+// GLM: OpenGL Math
+#include <glm/glm.hpp>
+
+// Shader storage buffer binding points used by EmitterVertex.shader.
+const unsigned int EMITTERS_BINDING = 0;
+const unsigned int EMITTER_TILES_BINDING = 1;
+const unsigned int EMITTER_TILE_INDICES_BINDING = 2;
+
+/**
+ * One ripple source, laid out to match the std430 Emitter struct in EmitterVertex.shader.
+ *
+ * The emitter adds amplitude * exp(-decay * d) * sin(-PI * d * frequency + waveTime + phase) at
+ * distance d from its center. Past radius that is below RippleEmitters::CUTOFF_AMPLITUDE, and the
+ * tiled path skips it.
+ */
+struct RippleEmitter
+{
+    glm::vec2 center;
+    float amplitude;
+    float frequency;
+    float phase;
+    float decay;
+    float radius;   // derived by RippleEmitters from amplitude and decay
+    float padding;
+};
+
+static_assert(sizeof(RippleEmitter) == 32, "RippleEmitter must match the std430 layout of the shader struct");
+
+/**
+ * A set of ripple emitters, stored in shader storage buffers so the vertex shader can sum any number
+ * of them without per-emitter uniforms or draw calls.
+ *
+ * Besides the emitters themselves, the plane is split into tiles and each tile gets the list of
+ * emitters whose radius reaches it. The tiled shader path only loops over the list of the vertex's
+ * tile instead of over every emitter.
+ */
+class RippleEmitters final
+{
+public:
+    // Emitters are cut off where their envelope drops below this amplitude.
+    static const float CUTOFF_AMPLITUDE;
+
+    RippleEmitters();
+
+    RippleEmitters(const RippleEmitters& rhs) = delete;
+    RippleEmitters(RippleEmitters&& rhs) = delete;
+
+    RippleEmitters& operator=(const RippleEmitters& rhs) = delete;
+    RippleEmitters& operator=(RippleEmitters&& rhs) = delete;
+
+    ~RippleEmitters();
+
+    // Replaces the emitters with a reproducible pseudo-random set spread over the plane.
+    void GenerateRandom(int count, float sizeX, float sizeZ, unsigned int seed);
+
+    void Add(const RippleEmitter& emitter);
+    void Clear();
+
+    // Rebuilds the per-tile emitter lists for a plane of the given size split into tilesX x tilesZ tiles.
+    void BuildTiles(int tilesX, int tilesZ, float sizeX, float sizeZ);
+
+    // Creates the buffers if needed, uploads the emitters and tile lists, and binds them to their binding points.
+    void Upload();
+
+    void Delete();
+
+    const std::vector<RippleEmitter>& GetEmitters() const;
+
+    // Average number of emitters per tile list, to compare against the emitter count.
+    double GetAverageEmittersPerTile() const;
+
+private:
+    std::vector<RippleEmitter> _emitters;
+
+    std::vector<glm::uvec2> _tiles;         // offset and count of each tile's range in _tileIndices
+    std::vector<GLuint> _tileIndices;       // emitter indices, grouped by tile
+
+    GLuint _emittersBufferId;
+    GLuint _tilesBufferId;
+    GLuint _tileIndicesBufferId;
+};
@@ -0,0 +1,71 @@
+#version 410 core
+
+// Picks how finely each coarse grid quad is tessellated from two limits per edge:
+// - the edge is cut into segments of about TARGET_EDGE_PIXELS on screen, so nothing is spent on
+//   sub-pixel triangles;
+// - segments are short enough for a chord of the ripple to stay within MAX_ERROR_PIXELS of the curve:
+//   for a curvature k the chord error of a segment of length h is about k * h^2 / 8.
+// The smaller count wins. Each edge level only depends on the edge's two corners, so neighboring
+// quads agree on their shared edges and no cracks open.
+
+layout (vertices = 4) out;
+
+layout (std140) uniform FrameUniforms  // filled from the FrameUniforms struct in FrameUniforms.h
+{
+    mat4 modelViewProjectMatrix;
+    vec4 newColor;
+    vec2 waveCenter;
+    float waveTime;
+    float amplitude;
+    float frequency;
+};
+
+uniform vec2 viewportSize;     // in pixels
+
+in vec3 controlPoint[];
+out vec3 evaluationPoint[];
+
+const float PI = 3.14159;
+const float TARGET_EDGE_PIXELS = 8.0;
+const float MAX_ERROR_PIXELS = 0.5;
+const float MAX_LEVEL = 64.0;
+
+vec2 ToScreen(vec3 position)
+{
+    vec4 clip = modelViewProjectMatrix * vec4(position, 1.0);
+    return (clip.xy / max(clip.w, 0.0001)) * 0.5 * viewportSize;
+}
+
+float EdgeLevel(vec3 a, vec3 b)
+{
+    float worldLength = distance(a, b);
+    float screenLength = distance(ToScreen(a), ToScreen(b));
+
+    // Largest curvature of amplitude * sin(PI * frequency * d): amplitude * (PI * frequency)^2.
+    float waveNumber = PI * frequency;
+    float curvature = amplitude * waveNumber * waveNumber;
+
+    // Chord error limit, converted to world units with this edge's on-screen scale.
+    float maxErrorWorld = MAX_ERROR_PIXELS * worldLength / max(screenLength, 0.0001);
+    float curvatureSegments = worldLength * sqrt(curvature / (8.0 * maxErrorWorld));
+    float screenSegments = screenLength / TARGET_EDGE_PIXELS;
+
+    return clamp(min(curvatureSegments, screenSegments), 1.0, MAX_LEVEL);
+}
+
+void main()
+{
+    evaluationPoint[gl_InvocationID] = controlPoint[gl_InvocationID];
+
+    if (gl_InvocationID == 0) {
+        // Outer level i is the edge at u = 0, v = 0, u = 1 and v = 1 in turn; the corners are
+        // (0, 0), (1, 0), (1, 1), (0, 1).
+        gl_TessLevelOuter[0] = EdgeLevel(controlPoint[3], controlPoint[0]);
+        gl_TessLevelOuter[1] = EdgeLevel(controlPoint[0], controlPoint[1]);
+        gl_TessLevelOuter[2] = EdgeLevel(controlPoint[1], controlPoint[2]);
+        gl_TessLevelOuter[3] = EdgeLevel(controlPoint[2], controlPoint[3]);
+
+        gl_TessLevelInner[0] = max(gl_TessLevelOuter[1], gl_TessLevelOuter[3]);
+        gl_TessLevelInner[1] = max(gl_TessLevelOuter[0], gl_TessLevelOuter[2]);
+    }
+}
@@ -0,0 +1,30 @@
+#version 410 core
+
+// Places each tessellated vertex on the coarse quad and displaces it, as Vertex.shader does.
+
+layout (quads, fractional_even_spacing, ccw) in;
+
+layout (std140) uniform FrameUniforms  // filled from the FrameUniforms struct in FrameUniforms.h
+{
+    mat4 modelViewProjectMatrix;
+    vec4 newColor;
+    vec2 waveCenter;
+    float waveTime;
+    float amplitude;
+    float frequency;
+};
+
+in vec3 evaluationPoint[];
+
+const float PI = 3.14159;
+
+void main()
+{
+    vec3 bottom = mix(evaluationPoint[0], evaluationPoint[1], gl_TessCoord.x);
+    vec3 top = mix(evaluationPoint[3], evaluationPoint[2], gl_TessCoord.x);
+    vec3 vertex = mix(bottom, top, gl_TessCoord.y);
+
+    float distance = length(vertex.xz - waveCenter);
+    float y = amplitude * sin(-PI * distance * frequency + waveTime);
+    gl_Position = modelViewProjectMatrix * vec4(vertex.x, y, vertex.z, 1);
+}
@@ -0,0 +1,59 @@
+#include "RollingStats.h"
+
+#include <algorithm>
+
+RollingStats::RollingStats(size_t capacity) :
+        _samples(capacity > 0 ? capacity : 1, 0.0),
+        _next(0),
+        _count(0)
+{
+    _sorted.reserve(_samples.size());
+}
+
+RollingStats::~RollingStats()
+{ }
+
+void RollingStats::Add(double sample)
+{
+    _samples[_next] = sample;
+    _next = (_next + 1) % _samples.size();
+    _count = std::min(_count + 1, _samples.size());
+}
+
+void RollingStats::Clear()
+{
+    _next = 0;
+    _count = 0;
+}
+
+double RollingStats::GetMin() const
+{
+    return _count ? *std::min_element(_samples.begin(), _samples.begin() + _count) : 0.0;
+}
+
+double RollingStats::GetAverage() const
+{
+    double sum = 0.0;
+    for (size_t index = 0; index < _count; ++index) {
+        sum += _samples[index];
+    }
+    return _count ? sum / _count : 0.0;
+}
+
+double RollingStats::GetPercentile99() const
+{
+    if (_count == 0) {
+        return 0.0;
+    }
+
+    // Nearest rank: the smallest sample that at least 99% of the samples don't exceed.
+    _sorted.assign(_samples.begin(), _samples.begin() + _count);
+    const size_t rank = (_count * 99 + 99) / 100 - 1;
+    std::nth_element(_sorted.begin(), _sorted.begin() + rank, _sorted.end());
+    return _sorted[rank];
+}
+
+size_t RollingStats::GetCount() const
+{
+    return _count;
+}
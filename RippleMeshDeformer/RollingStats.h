@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Minimum, average and 99th percentile over the last samples of a measurement, e.g. frame times.
+ *
+ * The samples live in a fixed size ring, so adding one never allocates once the ring is full.
+ */
+class RollingStats final
+{
+public:
+    explicit RollingStats(size_t capacity = 240);
+
+    RollingStats(const RollingStats& rhs) = delete;
+    RollingStats(RollingStats&& rhs) = delete;
+
+    RollingStats& operator=(const RollingStats& rhs) = delete;
+    RollingStats& operator=(RollingStats&& rhs) = delete;
+
+    ~RollingStats();
+
+    void Add(double sample);
+    void Clear();
+
+    // These return 0 while there are no samples.
+    double GetMin() const;
+    double GetAverage() const;
+    double GetPercentile99() const;
+
+    size_t GetCount() const;
+
+private:
+    std::vector<double> _samples;
+    size_t _next;
+    size_t _count;
+
+    mutable std::vector<double> _sorted;    // scratch space of GetPercentile99
+};
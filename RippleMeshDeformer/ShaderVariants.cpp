@@ -0,0 +1,73 @@
+#include "ShaderVariants.h"
+
+#include <sstream>
+
+ShaderVariants::ShaderVariants()
+{ }
+
+ShaderVariants::~ShaderVariants()
+{ }
+
+GLSLProgram* ShaderVariants::Get(const std::vector<ShaderStage>& stages, const ShaderDefines& defines)
+{
+    const std::string key = MakeKey(stages, defines);
+    std::map<std::string, std::unique_ptr<GLSLProgram>>::iterator iterator = _programs.find(key);
+    if (iterator != _programs.end()) {
+        return iterator->second.get();
+    }
+
+    std::unique_ptr<GLSLProgram> program = BuildAsync(stages, defines);
+    program->FinishLink();
+    if (!program->IsCreated()) {
+        return nullptr;
+    }
+
+    GLSLProgram* result = program.get();
+    _programs[key] = std::move(program);
+    return result;
+}
+
+std::unique_ptr<GLSLProgram> ShaderVariants::BuildAsync(const std::vector<ShaderStage>& stages, const ShaderDefines& defines)
+{
+    // Deferred, every stage is handed to the driver before anything waits on it.
+    std::unique_ptr<GLSLProgram> program(new GLSLProgram());
+    program->SetDeferredCompilation(true);
+    for (size_t index = 0; index < stages.size(); ++index) {
+        program->AddShaderFromFile(stages[index].type, stages[index].path, defines);
+    }
+    program->CreateAndLinkProgramAsync();
+    return program;
+}
+
+GLSLProgram* ShaderVariants::Replace(const std::vector<ShaderStage>& stages, const ShaderDefines& defines,
+                                     std::unique_ptr<GLSLProgram> program)
+{
+    _programs.clear();
+
+    GLSLProgram* result = program.get();
+    _programs[MakeKey(stages, defines)] = std::move(program);
+    return result;
+}
+
+size_t ShaderVariants::GetCount() const
+{
+    return _programs.size();
+}
+
+void ShaderVariants::Delete()
+{
+    // Each program deletes its GL object as it is destroyed.
+    _programs.clear();
+}
+
+std::string ShaderVariants::MakeKey(const std::vector<ShaderStage>& stages, const ShaderDefines& defines)
+{
+    std::ostringstream key;
+    for (size_t index = 0; index < stages.size(); ++index) {
+        key << stages[index].type << ":" << stages[index].path << ";";
+    }
+    for (ShaderDefines::const_iterator define = defines.begin(); define != defines.end(); ++define) {
+        key << define->first << "=" << define->second << ";";
+    }
+    return key.str();
+}
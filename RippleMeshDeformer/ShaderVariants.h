@@ -0,0 +1,61 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+#include "GLSLProgram.h"
+
+// One stage of a program variant: the shader type and the file its source is read from.
+struct ShaderStage
+{
+    GLenum type;
+    std::string path;
+};
+
+/**
+ * Programs built from the same shader files specialized with different sets of #defines.
+ *
+ * Each variant is compiled and linked the first time it is asked for and kept under a key made of its
+ * stages and defines, so switching back to it later costs nothing. With a ProgramBinaryCache set on
+ * GLSLProgram the variants are also restored from disk on later runs, keyed by their specialized source.
+ */
+class ShaderVariants final
+{
+public:
+    ShaderVariants();
+
+    ShaderVariants(const ShaderVariants& rhs) = delete;
+    ShaderVariants(ShaderVariants&& rhs) = delete;
+
+    ShaderVariants& operator=(const ShaderVariants& rhs) = delete;
+    ShaderVariants& operator=(ShaderVariants&& rhs) = delete;
+
+    ~ShaderVariants();
+
+    // Returns the variant, building it on first use, or nullptr if it doesn't link. Failed variants
+    // aren't kept, so asking again retries.
+    GLSLProgram* Get(const std::vector<ShaderStage>& stages, const ShaderDefines& defines);
+
+    // Keeps a linked program as the variant of its stages and defines, dropping every other variant,
+    // which was probably built from older sources and is rebuilt on its next Get.
+    GLSLProgram* Replace(const std::vector<ShaderStage>& stages, const ShaderDefines& defines,
+                         std::unique_ptr<GLSLProgram> program);
+
+    size_t GetCount() const;
+
+    void Delete();
+
+    static std::string MakeKey(const std::vector<ShaderStage>& stages, const ShaderDefines& defines);
+
+private:
+    // Reads the sources of a variant and starts compiling and linking it, without waiting for the
+    // driver; see GLSLProgram::CreateAndLinkProgramAsync.
+    static std::unique_ptr<GLSLProgram> BuildAsync(const std::vector<ShaderStage>& stages, const ShaderDefines& defines);
+
+    std::map<std::string, std::unique_ptr<GLSLProgram>> _programs;
+};
@@ -0,0 +1,130 @@
+#include "SharedWindow.h"
+
+#include <iostream>
+
+// GLM: OpenGL Math
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "UniformBuffer.h"
+
+SharedWindow::SharedWindow() :
+        _window(nullptr),
+        _yaw(0.0f),
+        _width(0),
+        _height(0),
+        _isRunning(false),
+        _frameCount(0)
+{ }
+
+SharedWindow::~SharedWindow()
+{
+    Destroy();
+}
+
+bool SharedWindow::Create(GLFWwindow* shareWindow, int width, int height, const char* title, float yaw)
+{
+    // The hints of the main window, such as the context version, still apply.
+    _window = glfwCreateWindow(width, height, title, nullptr, shareWindow);
+    if (_window == nullptr) {
+        std::cerr << "SharedWindow::Create: Can't open a window sharing the main context" << std::endl;
+        return false;
+    }
+    _yaw = yaw;
+
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(_window, &framebufferWidth, &framebufferHeight);
+    _width = framebufferWidth;
+    _height = framebufferHeight;
+
+    glfwSetWindowUserPointer(_window, this);
+    glfwSetFramebufferSizeCallback(_window, FramebufferSizeCallback);
+    return true;
+}
+
+void SharedWindow::Start(const ContextCallback& initContext, const ContextCallback& draw)
+{
+    _initContext = initContext;
+    _draw = draw;
+    _isRunning = true;
+    _thread = std::thread(&SharedWindow::Run, this);
+}
+
+void SharedWindow::Publish(const SharedFrame& frame)
+{
+    _frames.GetWriteSlot() = frame;
+    _frames.Publish();
+}
+
+void SharedWindow::Destroy()
+{
+    if (_thread.joinable()) {
+        _isRunning = false;
+        _thread.join();
+    }
+    if (_window != nullptr) {
+        glfwDestroyWindow(_window);
+        _window = nullptr;
+    }
+}
+
+GLFWwindow* SharedWindow::GetWindow() const
+{
+    return _window;
+}
+
+unsigned long long SharedWindow::GetFrameCount() const
+{
+    return _frameCount;
+}
+
+void SharedWindow::FramebufferSizeCallback(GLFWwindow* window, int width, int height)
+{
+    SharedWindow* sharedWindow = static_cast<SharedWindow*>(glfwGetWindowUserPointer(window));
+    sharedWindow->_width = width;
+    sharedWindow->_height = height;
+}
+
+void SharedWindow::Run()
+{
+    // A context is current on one thread at a time; this one stays on this thread until it stops.
+    glfwMakeContextCurrent(_window);
+    glfwSwapInterval(1);
+
+    GLuint vaoId;
+    glGenVertexArrays(1, &vaoId);
+    glBindVertexArray(vaoId);
+    _initContext();
+
+    // Binding points are context state, so this buffer feeds the shared programs in this context only.
+    UniformBuffer frameUniformBuffer;
+    frameUniformBuffer.Create(sizeof(FrameUniforms), FRAME_UNIFORMS_BINDING);
+
+    const glm::mat4 turn = glm::rotate(glm::mat4(1.0f), glm::radians(_yaw), glm::vec3(0.0f, 1.0f, 0.0f));
+    while (_isRunning) {
+        const SharedFrame& frame = _frames.Acquire();
+        const int width = _width;
+        const int height = _height;
+
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        if (frame.programId != 0 && width > 0 && height > 0) {
+            glViewport(0, 0, width, height);
+            const glm::mat4 projectionMatrix = glm::perspective(45.0f, static_cast<float>(width) / height, 1.0f, 1000.0f);
+
+            FrameUniforms uniforms = frame.uniforms;
+            uniforms.modelViewProjectMatrix = projectionMatrix * frame.modelViewMatrix * turn;
+            frameUniformBuffer.Update(uniforms);
+
+            glUseProgram(frame.programId);
+            _draw();
+        }
+
+        glfwSwapBuffers(_window);
+        ++_frameCount;
+    }
+
+    frameUniformBuffer.Delete();
+    glBindVertexArray(0);
+    glDeleteVertexArrays(1, &vaoId);
+    glFinish();
+    glfwMakeContextCurrent(nullptr);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+// GLFW: A simple API for creating windows, contexts and surfaces, and receiving input and events
+#include <GLFW/glfw3.h>
+
+// GLM: OpenGL Math
+#include <glm/glm.hpp>
+
+#include "FrameUniforms.h"
+#include "TripleBuffer.h"
+
+// What the main window hands a shared window every frame; the projection is the shared window's own.
+struct SharedFrame
+{
+    // Zeroed, so a window that starts before the first frame is published draws nothing.
+    SharedFrame() : uniforms(), modelViewMatrix(1.0f), programId(0) { }
+
+    FrameUniforms uniforms;     // modelViewProjectMatrix is left to the shared window
+    glm::mat4 modelViewMatrix;
+    GLuint programId;           // 0 until the first frame
+};
+
+/**
+ * A further window on the same scene, rendered from its own thread.
+ *
+ * Its context shares objects with the main window's, so the programs, the mesh buffers and any other
+ * buffers or textures exist once for every window. What contexts don't share is made for each one:
+ * its vertex array object, which is a container of the shared buffers, and its own FrameUniforms
+ * buffer on the same binding point, which carries its view. The main thread hands it the latest
+ * frame through a TripleBuffer, and the window's thread draws it at its display's own rate; a swap
+ * waiting for one display never holds up another. The shared objects have to be complete before
+ * Start(), and left unchanged while the window runs, except through the handed frames.
+ */
+class SharedWindow final
+{
+public:
+    // Called on the window's thread with its context current: once to set up the context, with its
+    // vertex array object bound, and then for every frame, with the frame uniforms bound and the
+    // program in use.
+    typedef std::function<void()> ContextCallback;
+
+    SharedWindow();
+
+    SharedWindow(const SharedWindow& rhs) = delete;
+    SharedWindow(SharedWindow&& rhs) = delete;
+
+    SharedWindow& operator=(const SharedWindow& rhs) = delete;
+    SharedWindow& operator=(SharedWindow&& rhs) = delete;
+
+    ~SharedWindow();
+
+    // Opens a window whose context shares objects with shareWindow's, drawing the scene turned by yaw
+    // degrees about the vertical axis. Main thread only, like every GLFW window function.
+    bool Create(GLFWwindow* shareWindow, int width, int height, const char* title, float yaw);
+
+    // Starts rendering on the window's own thread.
+    void Start(const ContextCallback& initContext, const ContextCallback& draw);
+
+    // Hands the window the latest frame; main thread, once per frame.
+    void Publish(const SharedFrame& frame);
+
+    // Stops the thread and destroys the window. Main thread only.
+    void Destroy();
+
+    GLFWwindow* GetWindow() const;
+
+    // Frames the window's thread has swapped.
+    unsigned long long GetFrameCount() const;
+
+private:
+    static void FramebufferSizeCallback(GLFWwindow* window, int width, int height);
+
+    void Run();
+
+    GLFWwindow* _window;
+    float _yaw;
+
+    // Framebuffer size, kept by the main thread's callback; GLFW only reports it there.
+    std::atomic<int> _width;
+    std::atomic<int> _height;
+
+    TripleBuffer<SharedFrame> _frames;
+    ContextCallback _initContext;
+    ContextCallback _draw;
+
+    std::thread _thread;
+    std::atomic<bool> _isRunning;
+    std::atomic<unsigned long long> _frameCount;
+};
@@ -0,0 +1,52 @@
+#version 330 core
+
+// Draws the heights of the wave simulation (WaveSimulation, WaveStep.shader). The grid point of a
+// vertex is its index, since the GridMesh vertices are in the same row-major order as the texels,
+// so the heights are read with texelFetch and no filtering or texture coordinates.
+//
+// Variants, selected with #defines (see ShaderVariants):
+//   USE_LIGHTING  1 also outputs a normal, from central differences of the neighbouring heights
+
+#ifndef USE_LIGHTING
+#define USE_LIGHTING 0
+#endif
+
+layout (location = 0) in vec3 vertex;    // use location so we don't need to call glBindAttribLocation(...)
+
+layout (std140) uniform FrameUniforms  // filled from the FrameUniforms struct in FrameUniforms.h
+{
+    mat4 modelViewProjectMatrix;
+    vec4 newColor;
+    vec2 waveCenter;
+    float waveTime;
+    float amplitude;
+    float frequency;
+};
+
+uniform sampler2D heights;  // WaveSimulation::GetHeightTextureId, one texel per grid point
+uniform int gridColumns;    // grid points along x, quadsX + 1
+uniform vec2 gridSpacing;   // world distance between neighbouring grid points along x and z
+
+#if USE_LIGHTING
+out vec3 vertexNormal;
+#endif
+
+void main()
+{
+    ivec2 gridPoint = ivec2(gl_VertexID % gridColumns, gl_VertexID / gridColumns);
+    float y = texelFetch(heights, gridPoint, 0).r;
+
+#if USE_LIGHTING
+    // One-sided at the edges, where the neighbour is clamped to the point itself.
+    ivec2 lastPoint = textureSize(heights, 0) - 1;
+    ivec2 minusX = ivec2(max(gridPoint.x - 1, 0), gridPoint.y);
+    ivec2 plusX = ivec2(min(gridPoint.x + 1, lastPoint.x), gridPoint.y);
+    ivec2 minusZ = ivec2(gridPoint.x, max(gridPoint.y - 1, 0));
+    ivec2 plusZ = ivec2(gridPoint.x, min(gridPoint.y + 1, lastPoint.y));
+    float dydx = (texelFetch(heights, plusX, 0).r - texelFetch(heights, minusX, 0).r) / (float(plusX.x - minusX.x) * gridSpacing.x);
+    float dydz = (texelFetch(heights, plusZ, 0).r - texelFetch(heights, minusZ, 0).r) / (float(plusZ.y - minusZ.y) * gridSpacing.y);
+    vertexNormal = normalize(vec3(-dydx, 1, -dydz));
+#endif
+
+    gl_Position = modelViewProjectMatrix * vec4(vertex.x, y, vertex.z, 1);
+}
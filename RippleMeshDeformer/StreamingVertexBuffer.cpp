@@ -0,0 +1,152 @@
+#include "StreamingVertexBuffer.h"
+
+#include <iostream>
+
+// How long a single wait for a region's fence blocks before it is retried.
+static const GLuint64 FENCE_WAIT_TIMEOUT_NS = 1000000;
+
+StreamingVertexBuffer::StreamingVertexBuffer() :
+        _bufferId(0),
+        _regionSize(0),
+        _region(0),
+        _mappedData(nullptr),
+        _waitCount(0)
+{
+    for (int region = 0; region < REGION_COUNT; ++region) {
+        _fences[region] = nullptr;
+    }
+}
+
+StreamingVertexBuffer::~StreamingVertexBuffer()
+{
+    Delete();
+}
+
+bool StreamingVertexBuffer::Create(GLsizeiptr regionSize, bool usePersistentMapping)
+{
+    Delete();
+
+    if (usePersistentMapping && !GLEW_VERSION_4_4 && !GLEW_ARB_buffer_storage) {
+        std::cerr << "StreamingVertexBuffer::Create: no buffer storage, falling back to orphaning" << std::endl;
+        usePersistentMapping = false;
+    }
+
+    _regionSize = regionSize;
+    _region = 0;
+    _waitCount = 0;
+
+    glGenBuffers(1, &_bufferId);
+    glBindBuffer(GL_ARRAY_BUFFER, _bufferId);
+
+    if (usePersistentMapping) {
+        // Coherent mapping makes CPU writes visible to later draws without explicit flushes.
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, _regionSize * REGION_COUNT, nullptr, flags);
+        _mappedData = static_cast<GLubyte*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, _regionSize * REGION_COUNT, flags));
+        if (!_mappedData) {
+            std::cerr << "StreamingVertexBuffer::Create: could not map the buffer" << std::endl;
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            Delete();
+            return false;
+        }
+    }
+    else {
+        glBufferData(GL_ARRAY_BUFFER, _regionSize, nullptr, GL_STREAM_DRAW);
+        _stagingData.resize(static_cast<size_t>(_regionSize));
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+void StreamingVertexBuffer::Delete()
+{
+    for (int region = 0; region < REGION_COUNT; ++region) {
+        if (_fences[region]) {
+            glDeleteSync(_fences[region]);
+            _fences[region] = nullptr;
+        }
+    }
+
+    if (_bufferId != 0) {
+        if (_mappedData) {
+            glBindBuffer(GL_ARRAY_BUFFER, _bufferId);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            _mappedData = nullptr;
+        }
+        glDeleteBuffers(1, &_bufferId);
+        _bufferId = 0;
+    }
+
+    _stagingData.clear();
+}
+
+GLvoid* StreamingVertexBuffer::BeginWrite()
+{
+    if (!_mappedData) {
+        return _stagingData.data();
+    }
+
+    // The fence was placed after the last frame that drew from this region, REGION_COUNT frames ago.
+    GLsync& fence = _fences[_region];
+    if (fence) {
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            ++_waitCount;
+            do {
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT_NS);
+            } while (status == GL_TIMEOUT_EXPIRED);
+        }
+        if (status == GL_WAIT_FAILED) {
+            std::cerr << "StreamingVertexBuffer::BeginWrite: waiting for the region's fence failed" << std::endl;
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    return _mappedData + _region * _regionSize;
+}
+
+void StreamingVertexBuffer::EndWrite()
+{
+    if (_mappedData) {
+        return;
+    }
+
+    // Orphan the old contents, which may still be in use, then fill a fresh store.
+    glBindBuffer(GL_ARRAY_BUFFER, _bufferId);
+    glBufferData(GL_ARRAY_BUFFER, _regionSize, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, _regionSize, _stagingData.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void StreamingVertexBuffer::FenceRegion()
+{
+    if (!_mappedData) {
+        return;
+    }
+
+    _fences[_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _region = (_region + 1) % REGION_COUNT;
+}
+
+GLuint StreamingVertexBuffer::GetBufferId() const
+{
+    return _bufferId;
+}
+
+GLintptr StreamingVertexBuffer::GetRegionOffset() const
+{
+    return _mappedData ? _region * _regionSize : 0;
+}
+
+bool StreamingVertexBuffer::IsPersistentlyMapped() const
+{
+    return _mappedData != nullptr;
+}
+
+unsigned long long StreamingVertexBuffer::GetWaitCount() const
+{
+    return _waitCount;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+/**
+ * A vertex buffer rewritten by the CPU every frame without stalling on the draws still reading it.
+ *
+ * With buffer storage (OpenGL 4.4 or ARB_buffer_storage) the buffer holds REGION_COUNT regions and
+ * stays persistently and coherently mapped. Every frame writes the next region in turn, and a fence
+ * placed after the frame's draws tells when the GPU is done with a region, so the CPU can fill one
+ * region while the GPU draws from the other two. Draws pick their region with GetRegionOffset().
+ *
+ * Without buffer storage, as on the macOS 4.1 context, a single region is orphaned with
+ * glBufferData(nullptr) every frame and refilled with glBufferSubData; the driver hands out fresh
+ * memory while earlier draws still use the old one.
+ */
+class StreamingVertexBuffer final
+{
+public:
+    static const int REGION_COUNT = 3;
+
+    StreamingVertexBuffer();
+
+    StreamingVertexBuffer(const StreamingVertexBuffer& rhs) = delete;
+    StreamingVertexBuffer(StreamingVertexBuffer&& rhs) = delete;
+
+    StreamingVertexBuffer& operator=(const StreamingVertexBuffer& rhs) = delete;
+    StreamingVertexBuffer& operator=(StreamingVertexBuffer&& rhs) = delete;
+
+    ~StreamingVertexBuffer();
+
+    // Falls back to orphaning if persistent mapping is asked for but the context can't do it.
+    bool Create(GLsizeiptr regionSize, bool usePersistentMapping);
+
+    void Delete();
+
+    // Returns where the next frame's regionSize bytes go, after waiting for the GPU to release them.
+    GLvoid* BeginWrite();
+
+    // Makes the written bytes available to the draws of the frame.
+    void EndWrite();
+
+    // Call once the frame's draws from the region are issued; moves on to the next region.
+    void FenceRegion();
+
+    GLuint GetBufferId() const;
+
+    // Byte offset of the region written last, for the draws of the frame.
+    GLintptr GetRegionOffset() const;
+
+    bool IsPersistentlyMapped() const;
+
+    // Number of BeginWrite() calls that had to wait for the GPU.
+    unsigned long long GetWaitCount() const;
+
+private:
+    GLuint _bufferId;
+    GLsizeiptr _regionSize;
+    int _region;
+
+    // Persistent mapping
+    GLubyte* _mappedData;
+    GLsync _fences[REGION_COUNT];
+
+    // Orphaning
+    std::vector<GLubyte> _stagingData;
+
+    unsigned long long _waitCount;
+};
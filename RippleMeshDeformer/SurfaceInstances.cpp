@@ -0,0 +1,96 @@
+#include "SurfaceInstances.h"
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+// GLM: OpenGL Math
+#include <glm/gtc/matrix_transform.hpp>
+
+// Gap between neighboring surfaces, as a fraction of a surface's size.
+static const float INSTANCE_SPACING = 1.25f;
+
+SurfaceInstances::SurfaceInstances() :
+        _bufferId(0)
+{ }
+
+SurfaceInstances::~SurfaceInstances()
+{
+    Delete();
+}
+
+void SurfaceInstances::GenerateGrid(int count, float sizeX, float sizeZ, unsigned int seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> phase(0.0f, 6.2831853f);
+    std::uniform_real_distribution<float> channel(0.25f, 1.0f);
+
+    const int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(count))));
+    const int rows = (count + columns - 1) / columns;
+    const float scale = 1.0f / (columns * INSTANCE_SPACING);
+
+    _instances.clear();
+    _instances.reserve(count);
+    for (int index = 0; index < count; ++index) {
+        const int column = index % columns;
+        const int row = index / columns;
+
+        // Cell centers of a columns x rows grid over the plane.
+        const glm::vec3 center((column + 0.5f - columns / 2.0f) * sizeX / columns, 0.0f,
+                               (row + 0.5f - rows / 2.0f) * sizeZ / columns);
+
+        SurfaceInstance instance;
+        instance.model = glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(scale, scale, scale));
+        instance.color = glm::vec4(channel(generator), channel(generator), channel(generator), 1.0f);
+        instance.phase = phase(generator);
+        _instances.push_back(instance);
+    }
+}
+
+void SurfaceInstances::Upload()
+{
+    if (_bufferId == 0) {
+        glGenBuffers(1, &_bufferId);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, _bufferId);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(_instances.size() * sizeof(SurfaceInstance)),
+                 _instances.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SurfaceInstances::SetInstanceAttributes() const
+{
+    glBindBuffer(GL_ARRAY_BUFFER, _bufferId);
+
+    // A mat4 attribute is four vec4 attributes, one per column.
+    for (unsigned int column = 0; column < 4; ++column) {
+        glVertexAttribPointer(INSTANCE_MODEL_LOCATION + column, 4, GL_FLOAT, GL_FALSE, sizeof(SurfaceInstance),
+                              reinterpret_cast<GLvoid*>(offsetof(SurfaceInstance, model) + column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(INSTANCE_MODEL_LOCATION + column);
+        glVertexAttribDivisor(INSTANCE_MODEL_LOCATION + column, 1);
+    }
+
+    glVertexAttribPointer(INSTANCE_COLOR_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(SurfaceInstance),
+                          reinterpret_cast<GLvoid*>(offsetof(SurfaceInstance, color)));
+    glEnableVertexAttribArray(INSTANCE_COLOR_LOCATION);
+    glVertexAttribDivisor(INSTANCE_COLOR_LOCATION, 1);
+
+    glVertexAttribPointer(INSTANCE_PHASE_LOCATION, 1, GL_FLOAT, GL_FALSE, sizeof(SurfaceInstance),
+                          reinterpret_cast<GLvoid*>(offsetof(SurfaceInstance, phase)));
+    glEnableVertexAttribArray(INSTANCE_PHASE_LOCATION);
+    glVertexAttribDivisor(INSTANCE_PHASE_LOCATION, 1);
+}
+
+void SurfaceInstances::Delete()
+{
+    if (_bufferId != 0) {
+        glDeleteBuffers(1, &_bufferId);
+        _bufferId = 0;
+    }
+}
+
+GLsizei SurfaceInstances::GetCount() const
+{
+    return static_cast<GLsizei>(_instances.size());
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+// GLM: OpenGL Math
+#include <glm/glm.hpp>
+
+// First attribute location of the per-instance data in InstancedVertex.shader: the model matrix takes
+// four consecutive locations, one per column, followed by the color and the phase.
+const unsigned int INSTANCE_MODEL_LOCATION = 1;
+const unsigned int INSTANCE_COLOR_LOCATION = 5;
+const unsigned int INSTANCE_PHASE_LOCATION = 6;
+
+/**
+ * One independent ripple surface of an instanced draw.
+ */
+struct SurfaceInstance
+{
+    glm::mat4 model;
+    glm::vec4 color;
+    float phase;    // added to the wave time of the surface
+};
+
+/**
+ * A set of ripple surfaces drawn with one glDrawElementsInstanced call.
+ *
+ * The per-surface transform, color and phase live in an instance buffer read through vertex
+ * attributes with a divisor of 1, so the surfaces share the grid's vertex and index buffers and
+ * nothing is set between them.
+ */
+class SurfaceInstances final
+{
+public:
+    SurfaceInstances();
+
+    SurfaceInstances(const SurfaceInstances& rhs) = delete;
+    SurfaceInstances(SurfaceInstances&& rhs) = delete;
+
+    SurfaceInstances& operator=(const SurfaceInstances& rhs) = delete;
+    SurfaceInstances& operator=(SurfaceInstances&& rhs) = delete;
+
+    ~SurfaceInstances();
+
+    // Replaces the instances with count surfaces laid out on a square grid that covers about the same
+    // sizeX x sizeZ area as a single surface, with reproducible pseudo-random phases and colors.
+    void GenerateGrid(int count, float sizeX, float sizeZ, unsigned int seed);
+
+    // Creates the instance buffer if needed and uploads the instances.
+    void Upload();
+
+    // Points the instance attributes of the bound VAO at the instance buffer.
+    void SetInstanceAttributes() const;
+
+    void Delete();
+
+    GLsizei GetCount() const;
+
+private:
+    std::vector<SurfaceInstance> _instances;
+
+    GLuint _bufferId;
+};
@@ -0,0 +1,12 @@
+#version 410 core
+
+// Passes the coarse grid corners on to RippleTessControl.shader; the ripple is evaluated after tessellation.
+
+layout (location = 0) in vec3 vertex;
+
+out vec3 controlPoint;
+
+void main()
+{
+    controlPoint = vertex;
+}
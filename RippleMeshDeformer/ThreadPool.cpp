@@ -0,0 +1,86 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount) :
+        _task(nullptr),
+        _taskCount(0),
+        _nextTask(0),
+        _busyWorkers(0),
+        _generation(0),
+        _isStopping(false)
+{
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+
+    // The calling thread takes part in every loop, so start one worker less.
+    for (unsigned int index = 1; index < threadCount; ++index) {
+        _workers.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isStopping = true;
+    }
+    _workAvailable.notify_all();
+
+    for (size_t index = 0; index < _workers.size(); ++index) {
+        _workers[index].join();
+    }
+}
+
+unsigned int ThreadPool::GetThreadCount() const
+{
+    return static_cast<unsigned int>(_workers.size()) + 1;
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _task = &task;
+        _taskCount = count;
+        _nextTask = 0;
+        _busyWorkers = static_cast<unsigned int>(_workers.size());
+        ++_generation;
+    }
+    _workAvailable.notify_all();
+
+    RunTasks();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _workDone.wait(lock, [this] { return _busyWorkers == 0; });
+    _task = nullptr;
+}
+
+void ThreadPool::WorkerLoop()
+{
+    unsigned long long lastGeneration = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _workAvailable.wait(lock, [this, lastGeneration] { return _isStopping || _generation != lastGeneration; });
+            if (_isStopping) {
+                return;
+            }
+            lastGeneration = _generation;
+        }
+
+        RunTasks();
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (--_busyWorkers == 0) {
+            _workDone.notify_one();
+        }
+    }
+}
+
+void ThreadPool::RunTasks()
+{
+    for (size_t index = _nextTask++; index < _taskCount; index = _nextTask++) {
+        (*_task)(index);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed set of worker threads for data-parallel loops.
+ *
+ * ParallelFor hands out the indices of a loop one at a time from a shared counter, so threads that
+ * finish early keep taking work and uneven tasks still balance out. The calling thread works too.
+ */
+class ThreadPool final
+{
+public:
+    // 0 threads means one per hardware thread, counting the calling thread.
+    explicit ThreadPool(unsigned int threadCount = 0);
+
+    ThreadPool(const ThreadPool& rhs) = delete;
+    ThreadPool(ThreadPool&& rhs) = delete;
+
+    ThreadPool& operator=(const ThreadPool& rhs) = delete;
+    ThreadPool& operator=(ThreadPool&& rhs) = delete;
+
+    ~ThreadPool();
+
+    // Number of threads running tasks, including the calling thread.
+    unsigned int GetThreadCount() const;
+
+    // Calls task(index) for every index in [0, count) and returns once all of them are done.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& task);
+
+private:
+    void WorkerLoop();
+    void RunTasks();
+
+    std::vector<std::thread> _workers;
+
+    std::mutex _mutex;
+    std::condition_variable _workAvailable;
+    std::condition_variable _workDone;
+
+    const std::function<void(size_t)>* _task;
+    size_t _taskCount;
+    std::atomic<size_t> _nextTask;
+
+    unsigned int _busyWorkers;
+    unsigned long long _generation;     // bumped for every ParallelFor so workers can tell new work from old
+    bool _isStopping;
+};
@@ -0,0 +1,97 @@
+#include "TileCuller.h"
+
+#include "GridMesh.h"
+
+TileCuller::TileCuller()
+{ }
+
+TileCuller::~TileCuller()
+{ }
+
+void TileCuller::Init(const GridMesh& gridMesh, float sizeX, float sizeZ, float maxHeight)
+{
+    const std::vector<GridTile>& tiles = gridMesh.GetTiles();
+    const size_t indexSize = gridMesh.GetIndexType() == GL_UNSIGNED_INT ? sizeof(GLuint) : sizeof(GLushort);
+    const float quadSizeX = sizeX / gridMesh.GetQuadsX();
+    const float quadSizeZ = sizeZ / gridMesh.GetQuadsZ();
+
+    _boxes.resize(tiles.size());
+    _tileCounts.resize(tiles.size());
+    _tileOffsets.resize(tiles.size());
+
+    // Room for every tile being visible, so culling never allocates per frame.
+    _counts.clear();
+    _offsets.clear();
+    _counts.reserve(tiles.size());
+    _offsets.reserve(tiles.size());
+
+    for (size_t index = 0; index < tiles.size(); ++index) {
+        const GridTile& tile = tiles[index];
+
+        Box& box = _boxes[index];
+        box.min = glm::vec3(tile.firstColumn * quadSizeX - sizeX / 2.0f, -maxHeight, tile.firstRow * quadSizeZ - sizeZ / 2.0f);
+        box.max = glm::vec3((tile.firstColumn + tile.columns) * quadSizeX - sizeX / 2.0f, maxHeight,
+                            (tile.firstRow + tile.rows) * quadSizeZ - sizeZ / 2.0f);
+
+        _tileCounts[index] = tile.indexCount;
+        _tileOffsets[index] = reinterpret_cast<const GLvoid*>(static_cast<size_t>(tile.firstIndex) * indexSize);
+    }
+}
+
+void TileCuller::Cull(const glm::mat4& modelViewProjectMatrix)
+{
+    // The frustum planes are sums and differences of the matrix rows (Gribb and Hartmann); a point p
+    // is inside when dot(plane, (p, 1)) >= 0 for all six. glm matrices are indexed by column.
+    glm::vec4 rows[4];
+    for (int row = 0; row < 4; ++row) {
+        rows[row] = glm::vec4(modelViewProjectMatrix[0][row], modelViewProjectMatrix[1][row],
+                              modelViewProjectMatrix[2][row], modelViewProjectMatrix[3][row]);
+    }
+    const glm::vec4 planes[6] = {
+        rows[3] + rows[0], rows[3] - rows[0],
+        rows[3] + rows[1], rows[3] - rows[1],
+        rows[3] + rows[2], rows[3] - rows[2]
+    };
+
+    _counts.clear();
+    _offsets.clear();
+
+    for (size_t index = 0; index < _boxes.size(); ++index) {
+        const Box& box = _boxes[index];
+
+        // A box is outside if, for some plane, even its corner furthest along the plane normal is behind it.
+        bool isVisible = true;
+        for (int plane = 0; plane < 6 && isVisible; ++plane) {
+            const glm::vec4& p = planes[plane];
+            const glm::vec3 corner(p.x >= 0.0f ? box.max.x : box.min.x,
+                                   p.y >= 0.0f ? box.max.y : box.min.y,
+                                   p.z >= 0.0f ? box.max.z : box.min.z);
+            isVisible = p.x * corner.x + p.y * corner.y + p.z * corner.z + p.w >= 0.0f;
+        }
+
+        if (isVisible) {
+            _counts.push_back(_tileCounts[index]);
+            _offsets.push_back(_tileOffsets[index]);
+        }
+    }
+}
+
+const GLsizei* TileCuller::GetCounts() const
+{
+    return _counts.data();
+}
+
+const GLvoid* const* TileCuller::GetOffsets() const
+{
+    return _offsets.data();
+}
+
+GLsizei TileCuller::GetVisibleTileCount() const
+{
+    return static_cast<GLsizei>(_counts.size());
+}
+
+GLsizei TileCuller::GetTileCount() const
+{
+    return static_cast<GLsizei>(_boxes.size());
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+// GLM: OpenGL Math
+#include <glm/glm.hpp>
+
+class GridMesh;
+
+/**
+ * Frustum culling of the tiles of a GridMesh split with GridMesh::SplitIntoTiles.
+ *
+ * Each tile is bounded by the box over its quads, extended along y by the largest height the ripple
+ * can reach, so a tile is only skipped when none of its deformed vertices can be on screen. Cull()
+ * tests every box against the frustum planes of the frame's model-view-projection matrix and lists
+ * the index ranges of the visible tiles, ready for one glMultiDrawElements call.
+ */
+class TileCuller final
+{
+public:
+    TileCuller();
+
+    TileCuller(const TileCuller& rhs) = delete;
+    TileCuller(TileCuller&& rhs) = delete;
+
+    TileCuller& operator=(const TileCuller& rhs) = delete;
+    TileCuller& operator=(TileCuller&& rhs) = delete;
+
+    ~TileCuller();
+
+    // maxHeight bounds the absolute displacement of any vertex, e.g. the ripple amplitude.
+    void Init(const GridMesh& gridMesh, float sizeX, float sizeZ, float maxHeight);
+
+    void Cull(const glm::mat4& modelViewProjectMatrix);
+
+    // Index counts and byte offsets of the visible tiles, as glMultiDrawElements takes them.
+    const GLsizei* GetCounts() const;
+    const GLvoid* const* GetOffsets() const;
+    GLsizei GetVisibleTileCount() const;
+
+    GLsizei GetTileCount() const;
+
+private:
+    struct Box
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    std::vector<Box> _boxes;
+    std::vector<GLsizei> _tileCounts;
+    std::vector<const GLvoid*> _tileOffsets;
+
+    std::vector<GLsizei> _counts;
+    std::vector<const GLvoid*> _offsets;
+};
@@ -0,0 +1,92 @@
+#include "TransformFeedbackDeformer.h"
+
+TransformFeedbackDeformer::TransformFeedbackDeformer() :
+        _captureVaoId(0),
+        _deformedVerticesId(0),
+        _vertexCount(0)
+{ }
+
+TransformFeedbackDeformer::~TransformFeedbackDeformer()
+{
+    Delete();
+}
+
+bool TransformFeedbackDeformer::Init(const std::string& shaderPath, GLuint sourceVerticesId, GLsizei vertexCount,
+                                     GLuint frameUniformsBinding)
+{
+    _vertexCount = vertexCount;
+
+    // Capture both outputs into one buffer, interleaved like DeformedVertex. There is no fragment
+    // shader; nothing is rasterized.
+    std::vector<std::string> varyings;
+    varyings.push_back("deformedPosition");
+    varyings.push_back("deformedNormal");
+
+    _captureProgram.AddShaderFromFile(GL_VERTEX_SHADER, shaderPath);
+    _captureProgram.SetTransformFeedbackVaryings(varyings, GL_INTERLEAVED_ATTRIBS);
+    _captureProgram.CreateAndLinkProgram();
+    if (!_captureProgram.IsCreated()) {
+        return false;
+    }
+
+    _captureProgram.BindUniformBlock("FrameUniforms", frameUniformsBinding);
+
+    glGenVertexArrays(1, &_captureVaoId);
+    glBindVertexArray(_captureVaoId);
+    glBindBuffer(GL_ARRAY_BUFFER, sourceVerticesId);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, static_cast<GLvoid*>(0));
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+
+    glGenBuffers(1, &_deformedVerticesId);
+    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, _deformedVerticesId);
+    glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, static_cast<GLsizeiptr>(vertexCount) * sizeof(DeformedVertex),
+                 nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0);
+
+    return true;
+}
+
+void TransformFeedbackDeformer::Deform()
+{
+    _captureProgram.UseProgram();
+    glBindVertexArray(_captureVaoId);
+
+    // Each grid point is one point primitive, so the capture keeps the GridMesh vertex order.
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, _deformedVerticesId);
+
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, _vertexCount);
+    glEndTransformFeedback();
+
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    glBindVertexArray(0);
+}
+
+void TransformFeedbackDeformer::ReadBack(std::vector<DeformedVertex>& vertices) const
+{
+    vertices.resize(_vertexCount);
+
+    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, _deformedVerticesId);
+    glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, 0, static_cast<GLsizeiptr>(_vertexCount) * sizeof(DeformedVertex),
+                       vertices.data());
+    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0);
+}
+
+void TransformFeedbackDeformer::Delete()
+{
+    if (_captureVaoId != 0) {
+        glDeleteVertexArrays(1, &_captureVaoId);
+        glDeleteBuffers(1, &_deformedVerticesId);
+        _captureVaoId = 0;
+        _deformedVerticesId = 0;
+    }
+}
+
+GLuint TransformFeedbackDeformer::GetBufferId() const
+{
+    return _deformedVerticesId;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+#include "DeformedVertex.h"
+#include "GLSLProgram.h"
+
+/**
+ * Deforms the grid once per frame with transform feedback, for contexts without compute shaders.
+ *
+ * Every grid point goes through CaptureVertex.shader as a point with rasterization disabled, and the
+ * deformed position and normal are captured into a buffer in GridMesh vertex order. Later passes
+ * draw from that buffer with the GridMesh index buffer, and ReadBack() copies it to the CPU.
+ * Transform feedback is core since OpenGL 3.0, so this works on the macOS 4.1 context.
+ */
+class TransformFeedbackDeformer final
+{
+public:
+    TransformFeedbackDeformer();
+
+    TransformFeedbackDeformer(const TransformFeedbackDeformer& rhs) = delete;
+    TransformFeedbackDeformer(TransformFeedbackDeformer&& rhs) = delete;
+
+    TransformFeedbackDeformer& operator=(const TransformFeedbackDeformer& rhs) = delete;
+    TransformFeedbackDeformer& operator=(TransformFeedbackDeformer&& rhs) = delete;
+
+    ~TransformFeedbackDeformer();
+
+    // Builds the capture program over the undeformed grid positions (vec3s in sourceVerticesId);
+    // returns false if the program didn't link.
+    bool Init(const std::string& shaderPath, GLuint sourceVerticesId, GLsizei vertexCount, GLuint frameUniformsBinding);
+
+    // Captures the deformation for the current frame uniforms. Leaves the capture program in use and
+    // no VAO bound.
+    void Deform();
+
+    // Copies the last captured vertices to the CPU. This waits for the GPU to finish the capture.
+    void ReadBack(std::vector<DeformedVertex>& vertices) const;
+
+    void Delete();
+
+    // The captured vertices, one DeformedVertex per grid point.
+    GLuint GetBufferId() const;
+
+private:
+    GLSLProgram _captureProgram;
+
+    GLuint _captureVaoId;       // reads the undeformed grid positions
+    GLuint _deformedVerticesId;
+
+    GLsizei _vertexCount;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+
+/**
+ * Hands the latest of a stream of values from one producer thread to one consumer thread without locks.
+ *
+ * Of the three slots, the producer owns one it writes into, the consumer one it reads from, and the
+ * third holds the latest published value. Publishing and acquiring each swap their own slot with that
+ * third one in a single atomic exchange, so neither side ever waits for the other: the producer can
+ * publish faster than the consumer acquires (values in between are dropped), and the consumer keeps
+ * reading its value until a newer one has been published.
+ */
+template <typename T>
+class TripleBuffer final
+{
+public:
+    TripleBuffer() : _writeIndex(0), _latest(1), _readIndex(2) { }
+
+    TripleBuffer(const TripleBuffer& rhs) = delete;
+    TripleBuffer(TripleBuffer&& rhs) = delete;
+
+    TripleBuffer& operator=(const TripleBuffer& rhs) = delete;
+    TripleBuffer& operator=(TripleBuffer&& rhs) = delete;
+
+    ~TripleBuffer() { }
+
+    // Producer: the slot to fill before the next Publish(). It holds whatever was written to it two or
+    // more publishes ago, so containers in it keep their capacity.
+    T& GetWriteSlot() { return _slots[_writeIndex]; }
+
+    // Producer: makes the write slot the latest value, and takes over the slot it replaces.
+    void Publish()
+    {
+        _writeIndex = _latest.exchange(_writeIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Consumer: returns the latest published value, which stays valid and unchanged until the next call.
+    const T& Acquire()
+    {
+        if (_latest.load(std::memory_order_relaxed) & FRESH) {
+            _readIndex = _latest.exchange(_readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        }
+        return _slots[_readIndex];
+    }
+
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH = 4;     // set in _latest when it was published after the consumer's last swap
+
+    T _slots[3];
+    int _writeIndex;                // owned by the producer
+    std::atomic<int> _latest;       // the shared slot, with the FRESH flag
+    int _readIndex;                 // owned by the consumer
+};
@@ -0,0 +1,60 @@
+#include "UniformBuffer.h"
+
+#include <iostream>
+
+UniformBuffer::UniformBuffer() :
+        _bufferHandle(0),
+        _bindingPoint(0),
+        _size(0)
+{ }
+
+UniformBuffer::~UniformBuffer()
+{
+    Delete();
+}
+
+void UniformBuffer::Create(GLsizeiptr size, GLuint bindingPoint)
+{
+    Delete();
+
+    _size = size;
+    _bindingPoint = bindingPoint;
+
+    glGenBuffers(1, &_bufferHandle);
+    glBindBuffer(GL_UNIFORM_BUFFER, _bufferHandle);
+    glBufferData(GL_UNIFORM_BUFFER, _size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // Attach the whole buffer to the binding point; uniform blocks bound to the same point read from it.
+    glBindBufferBase(GL_UNIFORM_BUFFER, _bindingPoint, _bufferHandle);
+}
+
+void UniformBuffer::Delete()
+{
+    if (_bufferHandle != 0) {
+        glDeleteBuffers(1, &_bufferHandle);
+        _bufferHandle = 0;
+    }
+}
+
+void UniformBuffer::Update(const GLvoid* data, GLsizeiptr size)
+{
+    if (size != _size) {
+        std::cerr << "UniformBuffer::Update: expected " << _size << " bytes, got " << size << std::endl;
+        return;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, _bufferHandle);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+GLuint UniformBuffer::GetHandle() const
+{
+    return _bufferHandle;
+}
+
+GLuint UniformBuffer::GetBindingPoint() const
+{
+    return _bindingPoint;
+}
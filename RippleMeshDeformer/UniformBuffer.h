@@ -0,0 +1,45 @@
+#pragma once
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+/**
+ * A uniform buffer object bound to a fixed binding point, refreshed with one buffer write per update.
+ *
+ * Programs pick it up by binding their uniform block to the same point with
+ * GLSLProgram::BindUniformBlock, so one buffer can feed any number of programs.
+ */
+class UniformBuffer final
+{
+public:
+    UniformBuffer();
+
+    UniformBuffer(const UniformBuffer& rhs) = delete;
+    UniformBuffer(UniformBuffer&& rhs) = delete;
+
+    UniformBuffer& operator=(const UniformBuffer& rhs) = delete;
+    UniformBuffer& operator=(UniformBuffer&& rhs) = delete;
+
+    ~UniformBuffer();
+
+    void Create(GLsizeiptr size, GLuint bindingPoint);
+
+    void Delete();
+
+    // Replaces the whole buffer contents; size must be the size given to Create().
+    void Update(const GLvoid* data, GLsizeiptr size);
+
+    template <typename T>
+    void Update(const T& data)
+    {
+        Update(&data, sizeof(T));
+    }
+
+    GLuint GetHandle() const;
+    GLuint GetBindingPoint() const;
+
+private:
+    GLuint _bufferHandle;
+    GLuint _bindingPoint;
+    GLsizeiptr _size;
+};
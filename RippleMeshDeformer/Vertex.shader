@@ -1,17 +1,113 @@
 #version 330 core
 
+// Variants, selected with #defines inserted by GLSLProgram::AddShaderFromFile (see ShaderVariants):
+//   VERTEX_FORMAT     VERTEX_FORMAT_FLOAT (the default) reads a vec3 per vertex, VERTEX_FORMAT_QUANTIZED
+//                     the grid column and row, scaled to x/z by gridScale and gridOffset
+//   USE_DAMPING       1 fades the ripple out with the distance from the center, exp(-DAMPING * distance)
+//   WAVE_AMPLITUDE,   literals that replace the amplitude and frequency of the uniform block, so the
+//   WAVE_FREQUENCY    compiler can fold them into the sine's argument
+//   USE_LIGHTING      1 also outputs the analytic normal of the ripple for the lit Fragment.shader
+//   USE_FAR_FIELD     1 fades the displacement out between FAR_FIELD_START and FAR_FIELD_END from the
+//                     camera, leaving the ripple to the per-pixel normals of Fragment.shader
+
+#define VERTEX_FORMAT_FLOAT 0
+#define VERTEX_FORMAT_QUANTIZED 1
+
+#ifndef VERTEX_FORMAT
+#define VERTEX_FORMAT VERTEX_FORMAT_FLOAT
+#endif
+#ifndef USE_DAMPING
+#define USE_DAMPING 0
+#endif
+#ifndef DAMPING
+#define DAMPING 1.0
+#endif
+#ifndef USE_LIGHTING
+#define USE_LIGHTING 0
+#endif
+#ifndef USE_FAR_FIELD
+#define USE_FAR_FIELD 0
+#endif
+
+#if VERTEX_FORMAT == VERTEX_FORMAT_QUANTIZED
+layout (location = 0) in vec2 gridPoint;    // 16-bit unsigned column and row, converted to float
+
+// x/z = gridPoint * gridScale + gridOffset, from GridMesh::GetQuantizedScale/Offset
+uniform vec2 gridScale;
+uniform vec2 gridOffset;
+#else
 layout (location = 0) in vec3 vertex;    // use location so we don't need to call glBindAttribLocation(...)
+#endif
+
+layout (std140) uniform FrameUniforms  // filled from the FrameUniforms struct in FrameUniforms.h
+{
+    mat4 modelViewProjectMatrix;
+    vec4 newColor;
+    vec2 waveCenter;
+    float waveTime;
+    float amplitude;
+    float frequency;
+};
 
-uniform float waveTime;
-uniform mat4 modelViewProjectMatrix;
+#ifdef WAVE_AMPLITUDE
+const float waveAmplitude = WAVE_AMPLITUDE;
+#else
+#define waveAmplitude amplitude
+#endif
+#ifdef WAVE_FREQUENCY
+const float waveFrequency = WAVE_FREQUENCY;
+#else
+#define waveFrequency frequency
+#endif
+
+#if USE_LIGHTING
+out vec3 vertexNormal;
+#endif
+#if USE_FAR_FIELD
+uniform vec3 cameraPosition;    // in world space
+
+out vec2 surfacePosition;       // x/z, for the per-pixel ripple
+out float farFieldWeight;       // share of the ripple left to Fragment.shader, 0 to 1
+#endif
 
-const float amplitude = 0.125;
-const float frequency = 4;
 const float PI = 3.14159;
 
 void main()
 {
-    float distance = length(vertex);
-    float y = amplitude * sin(-PI * distance * frequency + waveTime);
-    gl_Position = modelViewProjectMatrix * vec4(vertex.x, y, vertex.z, 1);
+#if VERTEX_FORMAT == VERTEX_FORMAT_QUANTIZED
+    vec2 position = gridPoint * gridScale + gridOffset;
+#else
+    vec2 position = vertex.xz;
+#endif
+
+    vec2 offset = position - waveCenter;
+    float distance = length(offset);
+    float phase = -PI * distance * waveFrequency + waveTime;
+    float y = waveAmplitude * sin(phase);
+#if USE_DAMPING
+    float damping = exp(-DAMPING * distance);
+    y *= damping;
+#endif
+
+#if USE_FAR_FIELD
+    farFieldWeight = smoothstep(FAR_FIELD_START, FAR_FIELD_END, length(vec3(position.x, 0, position.y) - cameraPosition));
+    surfacePosition = position;
+    y *= 1 - farFieldWeight;
+#endif
+
+#if USE_LIGHTING
+    // The height only depends on the distance, so the gradient is d(y)/d(distance) along the offset:
+    // a cosine and a few multiplies, with the sine's argument already at hand.
+    float slope = -waveAmplitude * PI * waveFrequency * cos(phase);
+#if USE_DAMPING
+    slope = (slope - DAMPING * waveAmplitude * sin(phase)) * damping;
+#endif
+#if USE_FAR_FIELD
+    slope *= 1 - farFieldWeight;
+#endif
+    vec2 gradient = distance > 0 ? slope * offset / distance : vec2(0);
+    vertexNormal = normalize(vec3(-gradient.x, 1, -gradient.y));
+#endif
+
+    gl_Position = modelViewProjectMatrix * vec4(position.x, y, position.y, 1);
 }
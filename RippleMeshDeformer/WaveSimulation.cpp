@@ -0,0 +1,172 @@
+#include "WaveSimulation.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Squared Courant number of every step, (wave speed * time step / grid spacing)^2: waves travel half a
+// grid point per step. The explicit scheme is stable in 2D up to 0.5.
+static const float COURANT_SQUARED = 0.25f;
+
+WaveSimulation::WaveSimulation() :
+        _dropsLocation(-1),
+        _currentIndex(0),
+        _gridPoints(0, 0),
+        _spacing(0.0f, 0.0f),
+        _stepRate(0),
+        _isStarted(false),
+        _nextStepTime(0.0),
+        _stepCount(0),
+        _skippedStepCount(0)
+{
+    _textureIds[0] = 0;
+    _textureIds[1] = 0;
+}
+
+WaveSimulation::~WaveSimulation()
+{
+    Delete();
+}
+
+bool WaveSimulation::Init(const std::string& shaderPath, int quadsX, int quadsZ, float sizeX, float sizeZ, int stepRate,
+                          float damping)
+{
+    _gridPoints = glm::ivec2(quadsX + 1, quadsZ + 1);
+    _spacing = glm::vec2(sizeX / quadsX, sizeZ / quadsZ);
+    _stepRate = stepRate;
+
+    _stepProgram.AddShaderFromFile(GL_COMPUTE_SHADER, shaderPath);
+    _stepProgram.CreateAndLinkProgram();
+    if (!_stepProgram.IsCreated()) {
+        return false;
+    }
+
+    _stepProgram.UseProgram();
+    _stepProgram.GetUniformHandle<glm::ivec2>("gridPoints").Set(_gridPoints);
+    _stepProgram.GetUniformHandle<float>("courantSquared").Set(COURANT_SQUARED);
+    _stepProgram.GetUniformHandle<float>("damping").Set(std::min(damping / stepRate, 1.0f));
+    _dropCountUniform = _stepProgram.GetUniformHandle<int>("dropCount");
+    _dropsLocation = _stepProgram.GetUniformHandle<glm::vec4>("drops").GetLocation();
+
+    // Both start flat, so the surface starts at rest; uploaded a row at a time to keep the zeros small.
+    const std::vector<float> zeros(static_cast<size_t>(_gridPoints.x), 0.0f);
+    glGenTextures(2, _textureIds);
+    for (int index = 0; index < 2; ++index) {
+        glBindTexture(GL_TEXTURE_2D, _textureIds[index]);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, _gridPoints.x, _gridPoints.y);
+        for (int row = 0; row < _gridPoints.y; ++row) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, row, _gridPoints.x, 1, GL_RED, GL_FLOAT, zeros.data());
+        }
+
+        // texelFetch only, but a texture is incomplete for it with the default mipmapped filter.
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    _currentIndex = 0;
+    _isStarted = false;
+    _stepCount = 0;
+    _skippedStepCount = 0;
+
+    // Room for every drop a step takes, so adding them never allocates while running.
+    _drops.clear();
+    _drops.reserve(MAX_DROPS);
+
+    return true;
+}
+
+void WaveSimulation::AddDrop(const glm::vec2& position, float radius, float height)
+{
+    if (_drops.size() >= static_cast<size_t>(MAX_DROPS)) {
+        return;
+    }
+
+    // World x/z to grid points: the plane is centered on the origin, like the GridMesh vertices.
+    const glm::vec2 gridPoint = position / _spacing + glm::vec2(_gridPoints.x - 1, _gridPoints.y - 1) * 0.5f;
+    const float gridRadius = std::max(radius / std::min(_spacing.x, _spacing.y), 2.0f);
+    _drops.push_back(glm::vec4(gridPoint.x, gridPoint.y, gridRadius, height));
+}
+
+int WaveSimulation::Advance(double time)
+{
+    const double stepTime = 1.0 / _stepRate;
+    if (!_isStarted) {
+        _nextStepTime = time + stepTime;
+        _isStarted = true;
+    }
+
+    _stepProgram.UseProgram();
+
+    int steps = 0;
+    for (; time >= _nextStepTime && steps < MAX_STEPS_PER_ADVANCE; ++steps) {
+        Step();
+        _nextStepTime += stepTime;
+    }
+
+    // Too far behind, e.g. after the window was dragged: drop the backlog rather than catch up on it.
+    if (time >= _nextStepTime) {
+        const double behind = std::floor((time - _nextStepTime) / stepTime) + 1.0;
+        _skippedStepCount += static_cast<unsigned long long>(behind);
+        _nextStepTime += behind * stepTime;
+    }
+
+    if (steps > 0) {
+        // Make the last step's writes visible to the vertex shader's texelFetch.
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    }
+    return steps;
+}
+
+void WaveSimulation::Step()
+{
+    // Read the latest heights; read the ones before them and overwrite them with the next.
+    glBindImageTexture(0, _textureIds[_currentIndex], 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+    glBindImageTexture(1, _textureIds[1 - _currentIndex], 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32F);
+
+    _dropCountUniform.Set(static_cast<int>(_drops.size()));
+    if (!_drops.empty()) {
+        glUniform4fv(_dropsLocation, static_cast<GLsizei>(_drops.size()), &_drops[0][0]);
+    }
+
+    // One invocation per grid point, rounded up to whole work groups.
+    glDispatchCompute((_gridPoints.x + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE,
+                      (_gridPoints.y + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, 1);
+
+    // The next step reads what this one wrote.
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    // Drops push the surface for one step, which gives it the velocity to ripple out.
+    _drops.clear();
+
+    _currentIndex = 1 - _currentIndex;
+    ++_stepCount;
+}
+
+void WaveSimulation::Delete()
+{
+    if (_textureIds[0] != 0) {
+        glDeleteTextures(2, _textureIds);
+        _textureIds[0] = 0;
+        _textureIds[1] = 0;
+    }
+}
+
+GLuint WaveSimulation::GetHeightTextureId() const
+{
+    return _textureIds[_currentIndex];
+}
+
+long long WaveSimulation::GetTextureBytes() const
+{
+    return 2LL * _gridPoints.x * _gridPoints.y * static_cast<long long>(sizeof(float));
+}
+
+unsigned long long WaveSimulation::GetStepCount() const
+{
+    return _stepCount;
+}
+
+unsigned long long WaveSimulation::GetSkippedStepCount() const
+{
+    return _skippedStepCount;
+}
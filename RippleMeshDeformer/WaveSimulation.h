@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// GLEW: OpenGL Extension Wrangler
+#include <GL/glew.h>
+
+// GLM: OpenGL Math
+#include <glm/glm.hpp>
+
+#include "GLSLProgram.h"
+
+/**
+ * An interactive ripple: the damped 2D wave equation, stepped on the GPU at a fixed rate.
+ *
+ * The heights live in two GL_R32F textures with one texel per grid point, in GridMesh order. A step
+ * of WaveStep.shader reads the latest heights and the ones before them, and overwrites the older
+ * texture with the next heights; the two then swap roles, so no copy is ever made. Every step moves
+ * waves by half a grid point, the most the explicit scheme allows in 2D with room to spare, so the
+ * step rate sets how fast waves travel across the grid, independently of the frame rate. The edges
+ * are held at height 0 and reflect waves back in. Compute shaders and image load/store need OpenGL 4.3.
+ */
+class WaveSimulation final
+{
+public:
+    // Work group size of WaveStep.shader along x and z.
+    static const int WORK_GROUP_SIZE = 16;
+
+    // Drops applied by one step, as sized in WaveStep.shader; further drops before it are ignored.
+    static const int MAX_DROPS = 16;
+
+    // Steps one Advance() runs at most; any further steps it is behind by are skipped.
+    static const int MAX_STEPS_PER_ADVANCE = 64;
+
+    WaveSimulation();
+
+    WaveSimulation(const WaveSimulation& rhs) = delete;
+    WaveSimulation(WaveSimulation&& rhs) = delete;
+
+    WaveSimulation& operator=(const WaveSimulation& rhs) = delete;
+    WaveSimulation& operator=(WaveSimulation&& rhs) = delete;
+
+    ~WaveSimulation();
+
+    // Builds the step program and a flat surface of (quadsX + 1) x (quadsZ + 1) points on a sizeX x
+    // sizeZ plane, stepped stepRate times per second of simulation time. Damping is the share of its
+    // vertical velocity the surface loses per second. Returns false if the program didn't link.
+    bool Init(const std::string& shaderPath, int quadsX, int quadsZ, float sizeX, float sizeZ, int stepRate, float damping);
+
+    // Pushes the surface up (or down, for a negative height) around a point of the plane, in world x/z,
+    // at the next step. The radius is in world units, and at least two grid points.
+    void AddDrop(const glm::vec2& position, float radius, float height);
+
+    // Runs the steps due by a simulation time, the first call only setting the start. Leaves the step
+    // program in use, and the heights visible to texture fetches. Returns the number of steps run.
+    int Advance(double time);
+
+    void Delete();
+
+    // The latest heights, a GL_R32F texture with one texel per grid point.
+    GLuint GetHeightTextureId() const;
+
+    // Bytes of the two height textures.
+    long long GetTextureBytes() const;
+
+    // Steps run since Init(), and steps skipped because Advance() fell too far behind.
+    unsigned long long GetStepCount() const;
+    unsigned long long GetSkippedStepCount() const;
+
+private:
+    void Step();
+
+    GLSLProgram _stepProgram;
+    UniformHandle<int> _dropCountUniform;
+    GLint _dropsLocation;
+
+    // The texture with the latest heights is _textureIds[_currentIndex]; the other one holds the heights
+    // of the step before.
+    GLuint _textureIds[2];
+    int _currentIndex;
+
+    glm::ivec2 _gridPoints;
+    glm::vec2 _spacing;
+    int _stepRate;
+
+    // Drops for the next step: grid point x/z, radius in grid points, height.
+    std::vector<glm::vec4> _drops;
+
+    bool _isStarted;
+    double _nextStepTime;
+    unsigned long long _stepCount;
+    unsigned long long _skippedStepCount;
+};
@@ -0,0 +1,69 @@
+#version 430 core
+
+// One step of the damped 2D wave equation (WaveSimulation), one invocation per grid point:
+//
+//     next = current + (current - previous) * (1 - damping) + courantSquared * laplacian(current)
+//
+// Each grid point only reads its own previous height, so the next heights overwrite the previous ones
+// in place, and WaveSimulation swaps the two textures between steps.
+
+layout (local_size_x = 16, local_size_y = 16) in;     // WaveSimulation::WORK_GROUP_SIZE
+
+layout (r32f, binding = 0) readonly uniform image2D currentHeights;
+layout (r32f, binding = 1) uniform image2D previousHeights;     // overwritten with the next heights
+
+uniform ivec2 gridPoints;       // number of grid points along x and z
+uniform float courantSquared;   // (wave speed * time step / grid spacing)^2
+uniform float damping;          // share of the vertical velocity lost per step
+
+// Drops pushing the surface for this step: grid point x/z, radius in grid points, height.
+uniform int dropCount;
+uniform vec4 drops[16];         // WaveSimulation::MAX_DROPS
+
+const float PI = 3.14159;
+
+// Current heights of the work group's grid points plus a one point apron, for the Laplacian.
+shared float heights[18][18];
+
+float CurrentHeight(ivec2 gridPoint)
+{
+    // Past the edges the surface is held at 0, which reflects waves back in.
+    if (any(lessThan(gridPoint, ivec2(0))) || any(greaterThanEqual(gridPoint, gridPoints))) {
+        return 0;
+    }
+
+    float height = imageLoad(currentHeights, gridPoint).r;
+    for (int index = 0; index < dropCount; ++index) {
+        float distance = length(vec2(gridPoint) - drops[index].xy);
+        if (distance < drops[index].z) {
+            height += drops[index].w * 0.5 * (cos(PI * distance / drops[index].z) + 1);
+        }
+    }
+    return height;
+}
+
+void main()
+{
+    // Load each point of the group and its apron once; 18 x 18 points over 256 invocations.
+    ivec2 apronOrigin = ivec2(gl_WorkGroupID.xy) * 16 - 1;
+    for (uint cell = gl_LocalInvocationIndex; cell < 18u * 18u; cell += 256u) {
+        ivec2 local = ivec2(cell % 18u, cell / 18u);
+        heights[local.y][local.x] = CurrentHeight(apronOrigin + local);
+    }
+
+    barrier();
+
+    ivec2 gridPoint = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(gridPoint, gridPoints))) {
+        return;
+    }
+
+    ivec2 local = ivec2(gl_LocalInvocationID.xy) + 1;
+    float height = heights[local.y][local.x];
+    float laplacian = heights[local.y][local.x - 1] + heights[local.y][local.x + 1]
+                      + heights[local.y - 1][local.x] + heights[local.y + 1][local.x] - 4 * height;
+
+    float previous = imageLoad(previousHeights, gridPoint).r;
+    float next = height + (height - previous) * (1 - damping) + courantSquared * laplacian;
+    imageStore(previousHeights, gridPoint, vec4(next));
+}
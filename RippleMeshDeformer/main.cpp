@@ -24,7 +24,21 @@
  * to provide us with the desired results.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 // GLEW: OpenGL Extension Wrangler
 #define GLEW_STATIC
@@ -38,17 +52,69 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "AllocationCounter.h"
+#include "AsyncReadback.h"
+#include "BakePlayer.h"
+#include "BakeWriter.h"
+#include "Benchmark.h"
+#include "ComputeDeformer.h"
+#include "CpuDeformer.h"
+#include "CpuWaveSolver.h"
+#include "FileWatcher.h"
+#include "FrameState.h"
+#include "FrameUniforms.h"
 #include "GLSLProgram.h"
+#include "GpuTimer.h"
+#include "GridMesh.h"
+#include "LodPatches.h"
+#include "Options.h"
+#include "ProgramBinaryCache.h"
+#include "ProgramBuilder.h"
+#include "RippleEmitters.h"
+#include "RollingStats.h"
+#include "ShaderVariants.h"
+#include "SharedWindow.h"
+#include "StreamingVertexBuffer.h"
+#include "SurfaceInstances.h"
+#include "TileCuller.h"
+#include "ThreadPool.h"
+#include "TransformFeedbackDeformer.h"
+#include "TripleBuffer.h"
+#include "UniformBuffer.h"
+#include "WaveSimulation.h"
 
 // Function prototypes
 GLFWwindow* InitGlfw();
-void InitGlShaders();
-void InitMesh();
+bool CheckGlRequirements();
+bool InitGlShaders();
+bool UseRippleVariant();
+void InitProgramUniforms();
+void UpdateShaderReload();
+bool InitMesh();
+bool RunCpuBenchmark();
+bool RunCpuSimulation();
+bool RunBenchmark(GLFWwindow* window);
+bool RunBake(GLFWwindow* window);
+long long GetBufferBytes();
 void GlfwErrorCallback(int error, const char* description);
 void GlfwFramebufferResizeCallback(GLFWwindow *window, int width, int height);
 void GlfwKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mode);
+void GlfwMouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 void GlfwWindowRefreshCallback(GLFWwindow *window);
 void Render(GLFWwindow* window);
+void UpdateFrameState(FrameState& state, double time, bool deformOnCpu);
+void StartUpdateThread();
+void StopUpdateThread();
+void RunUpdateThread();
+void ReportTimings(GLFWwindow* window);
+void QueueReadback();
+void QueueHeightsReadback(const std::function<void(const float* heights, size_t count)>& callback);
+void SetGridVertexAttributes();
+bool StartSharedWindows(GLFWwindow* window);
+void StopSharedWindows();
+bool IsAnySharedWindowClosing();
+void InitSharedWindowContext();
+void DrawSharedWindow();
 
 // Window dimensions when the application is started
 const GLuint WIDTH = 1280;
@@ -58,67 +124,324 @@ static const char* VERTEX_SHADER_PATH =
         "/Users/john/Dev/OpenGL/RippleMeshDeformer/RippleMeshDeformer/Vertex.shader";
 static const char* FRAGMENT_SHADER_PATH =
         "/Users/john/Dev/OpenGL/RippleMeshDeformer/RippleMeshDeformer/Fragment.shader";
+static const char* PROCEDURAL_VERTEX_SHADER_PATH =
+        "/Users/john/Dev/OpenGL/RippleMeshDeformer/RippleMeshDeformer/ProceduralVertex.shader";
+static const char* EMITTER_VERTEX_SHADER_PATH =
+        "/Users/john/Dev/OpenGL/RippleMeshDeformer/RippleMeshDeformer/EmitterVertex.shader";
+static const char* DEFORMED_VERTEX_SHADER_PATH =
+        "/Users/john/Dev/OpenGL/RippleMeshDeformer/RippleMeshDeformer/DeformedVertex.shader";
+static const char* DEFORM_COMPUTE_SHADER_PATH =
+        "/Users/john/Dev/OpenGL/RippleMeshDeformer/RippleMeshDeformer/DeformCompute.shader";
+static const char* LOD_PATCH_VERTEX_SHADER_PATH =
+        "/Users/john/Dev/OpenGL/RippleMeshDeformer/RippleMeshDeformer/LodPatchVertex.shader";
+static const char* TESS_VERTEX_SHADER_PATH =
+        "/Users/john/Dev/OpenGL/RippleMeshDeformer/RippleMeshDeformer/TessVertex.shader";
+static const char* RIPPLE_TESS_CONTROL_SHADER_PATH =
+        "/Users/john/Dev/OpenGL/RippleMeshDeformer/RippleMeshDeformer/RippleTessControl.shader";
+static const char* RIPPLE_TESS_EVALUATION_SHADER_PATH =
+        "/Users/john/Dev/OpenGL/RippleMeshDeformer/RippleMeshDeformer/RippleTessEvaluation.shader";
+static const char* INSTANCED_VERTEX_SHADER_PATH =
+        "/Users/john/Dev/OpenGL/RippleMeshDeformer/RippleMeshDeformer/InstancedVertex.shader";
+static const char* INSTANCED_FRAGMENT_SHADER_PATH =
+        "/Users/john/Dev/OpenGL/RippleMeshDeformer/RippleMeshDeformer/InstancedFragment.shader";
+static const char* CAPTURE_VERTEX_SHADER_PATH =
+        "/Users/john/Dev/OpenGL/RippleMeshDeformer/RippleMeshDeformer/CaptureVertex.shader";
+static const char* SIMULATED_VERTEX_SHADER_PATH =
+        "/Users/john/Dev/OpenGL/RippleMeshDeformer/RippleMeshDeformer/SimulatedVertex.shader";
+static const char* WAVE_STEP_SHADER_PATH =
+        "/Users/john/Dev/OpenGL/RippleMeshDeformer/RippleMeshDeformer/WaveStep.shader";
 
-// The GLSL program
-GLSLProgram glslProgram;
+// The GLSL program, one of the variants of its shaders specialized by programDefines
+ShaderVariants shaderVariants;
+std::vector<ShaderStage> programStages;
+ShaderDefines programDefines;
+GLSLProgram* glslProgram = nullptr;
+bool isRippleProgram = false;   // built from Vertex.shader, whose damping can be switched at runtime
 
-// The vertex array and vertex buffer object IDs
+// Hot reload: the program's shader files, and the thread that rebuilds the program after they changed
+FileWatcher shaderWatcher;
+ProgramBuilder programBuilder;
+double lastShaderPoll = 0.0;
+const double SHADER_POLL_INTERVAL = 0.25;
+
+// Linked program binaries from earlier runs
+ProgramBinaryCache programBinaryCache;
+
+// Per-frame ripple parameters, uploaded to the uniform buffer with one write per frame
+FrameUniforms frameUniforms;
+UniformBuffer frameUniformBuffer;
+
+// The vertex array and vertex buffer object IDs, and the program's attribute the grid vertices feed
 GLuint vaoId;
 GLuint vboVerticesId;
 GLuint vboIndicesId;
+GLuint gridVertexLocation = 0;
+
+// The further windows of --windows, drawing the same buffers with the same programs from their own threads
+std::vector<std::unique_ptr<SharedWindow>> sharedWindows;
 
 // Size of plane in world space
 const float SIZE_X = 4;
 const float SIZE_Z = 4;
-const float HALF_SIZE_X = SIZE_X / 2.0f;
-const float HALF_SIZE_Z = SIZE_Z / 2.0f;
 
-const int NBR_OF_QUADS_X = 40;
-const int NBR_OF_QUADS_Z = 40;
+// Settings parsed from the command line
+Options options;
 
 // Ripple mesh vertices and indices
-glm::vec3 vertices[(NBR_OF_QUADS_X + 1) * (NBR_OF_QUADS_Z + 1)];
-const int TOTAL_INDICES = NBR_OF_QUADS_X * NBR_OF_QUADS_Z * 2 * 3;
-GLushort indices[TOTAL_INDICES];
+GridMesh gridMesh;
+
+// Independent surfaces drawn by --instances
+SurfaceInstances surfaceInstances;
+
+// Frustum culling of the grid tiles for --cull, and the visible tile count last reported
+TileCuller tileCuller;
+GLsizei reportedVisibleTileCount = -1;
+
+// Level of detail patches for --mesh patches: world size of a patch, distance up to which patches
+// stay at the finest level, and the triangle count last reported
+LodPatches lodPatches;
+const float LOD_PATCH_SIZE = 2.0f;
+const float LOD_DISTANCE = 2.0f;
+UniformHandle<glm::ivec2> patchOriginUniform;
+unsigned long long reportedPatchTriangleCount = 0;
+
+// Ripple emitters summed by EmitterVertex.shader, and the number of culling tiles along each axis
+RippleEmitters rippleEmitters;
+const int EMITTER_TILES = 32;
+
+// Deform the grid once per frame into a buffer the drawing passes read from
+ComputeDeformer computeDeformer;
+TransformFeedbackDeformer transformFeedbackDeformer;
+
+// CPU reference deformation, for benchmarking and for checking the GPU paths
+CpuDeformer cpuDeformer;
+
+// The CPU deformer's threads and the buffer --deform cpu streams its output through
+std::unique_ptr<ThreadPool> threadPool;
+StreamingVertexBuffer streamingVertexBuffer;
 
 const GLfloat RIPPLE_DISPLACEMENT_SPEED = 2.0;
+const GLfloat RIPPLE_AMPLITUDE = 0.125f;
+const GLfloat RIPPLE_FREQUENCY = 4.0f;
+
+// Framebuffer size in pixels, for the screen-space tessellation levels of --deform tessellation
+UniformHandle<glm::vec2> viewportSizeUniform;
+
+// Camera position in world space, which the vertex shader fades the displacement of --far-field by
+UniformHandle<glm::vec3> cameraPositionUniform;
+
+// Wave equation of --deform simulation, and the drops that keep it moving: one at a random point every
+// DROP_INTERVAL seconds of simulation time, plus one wherever the surface is clicked
+WaveSimulation waveSimulation;
+const unsigned int SIMULATION_HEIGHTS_UNIT = 0;
+const float SIMULATION_DAMPING = 0.5f;
+const double DROP_INTERVAL = 0.5;
+const float DROP_RADIUS = 0.08f;
+const float DROP_HEIGHT = 0.05f;
+std::mt19937 dropGenerator(1);
+double nextDropTime = -1.0;
+
+// Bake file drawn by --play in place of the simulation
+BakePlayer bakePlayer;
 
-// Transformation variables
+// A benchmark or a bake steps the simulation by one 60 Hz display frame per frame, however fast it renders.
+const double BENCHMARK_SIMULATION_FRAME_TIME = 1.0 / 60.0;
+double benchmarkSimulationTime = 0.0;
+
+// --bake and --cpu-simulation sample frames at this rate, the display rate --deform simulation is tuned
+// for; bakeFrame is the frame --bake is rendering.
+const int BAKE_FRAME_RATE = 60;
+int bakeFrame = 0;
+
+// Reads from the GPU, delivered a few frames later instead of waited for: every frame's heights or pixels
+// with --readback, and the frames of --bake. The heights are copied out of the deformed vertices, and
+// the latest results kept for the timing report.
+AsyncReadback asyncReadback;
+std::vector<float> readbackHeights;
+glm::vec2 readbackHeightRange(0.0f, 0.0f);
+uint64_t readbackChecksum = 0;
+
+// Pixels the --readback pixels checksum samples, spread evenly over the frame, so that it costs the
+// render thread the same small amount at any window size.
+const size_t CHECKSUM_SAMPLE_COUNT = 4096;
+
+// Share of the measured copy bandwidth above which the CPU wave solver is reported as bandwidth-bound.
+const double BANDWIDTH_BOUND_SHARE = 0.7;
+
+// Rolling frame timings, in milliseconds, and when they were last reported
+RollingStats pollTimes;
+RollingStats renderTimes;
+RollingStats swapTimes;
+RollingStats gpuTimes;
+GpuTimer gpuTimer;
+double lastTimingReport = 0.0;
+const double TIMING_REPORT_INTERVAL = 1.0;
+
+// Untimed frames rendered before a benchmark, so that it starts with warm caches and settled clocks.
+const int BENCHMARK_WARMUP_FRAMES = 10;
+
+// Transformation variables. The camera is input, set on the main thread and read by UpdateFrameState()
+// on the update thread with --update-rate, so its values are atomic.
 glm::mat4 projectionMatrix;
-float rX = 500.0, rY = -75.0, distance = -5.0;
+std::atomic<float> rX(500.0f), rY(-75.0f), distance(-5.0f);
+
+// Frame states: produced by the fixed-step update thread with --update-rate, otherwise by Render() itself
+TripleBuffer<FrameState> frameStates;
+FrameState renderFrameState;
+std::thread updateThread;
+std::atomic<bool> isUpdateThreadRunning(false);
 
 int main(int argc, const char* argv[])
 {
+    if (!ParseOptions(argc, argv, options)) {
+        return EXIT_FAILURE;
+    }
+
+    if (options.benchmarkSweepFrames > 0) {
+        return RunBenchmarkSweep(argv[0], options) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.cpuBenchmarkFrames > 0) {
+        return RunCpuBenchmark() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.cpuSimulationFrames > 0) {
+        return RunCpuSimulation() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // A bake brings its own grid.
+    if (!options.playbackInput.empty()) {
+        if (!bakePlayer.Open(options.playbackInput)) {
+            return EXIT_FAILURE;
+        }
+        const BakeHeader& header = bakePlayer.GetHeader();
+        options.quadsX = static_cast<int>(header.columns) - 1;
+        options.quadsZ = static_cast<int>(header.rows) - 1;
+        std::cout << "Playing " << options.playbackInput << ": " << header.columns << "x" << header.rows << " heights, "
+                  << header.frameCount << " frames at " << header.frameRate << " frames per second, "
+                  << GetOptionName(header.encoding) << std::endl;
+    }
+
+    if (!InitMesh()) {
+        return EXIT_FAILURE;
+    }
+
     GLFWwindow* window = InitGlfw();
 
+    if (!CheckGlRequirements()) {
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
+
     int width, height;
     glfwGetFramebufferSize(window, &width, &height);
     glViewport(0, 0, width, height);
 
     projectionMatrix = glm::perspective(45.0f, static_cast<GLfloat>(width / height), 1.0f, 1000.0f);
 
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    if (options.shading == Shading::Lit) {
+        glEnable(GL_DEPTH_TEST);
+    }
+    else {
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    }
 
-    InitMesh();
+    if (!options.shaderCacheDirectory.empty() && programBinaryCache.Init(options.shaderCacheDirectory)) {
+        GLSLProgram::SetBinaryCache(&programBinaryCache);
+    }
 
-    InitGlShaders();
-    glslProgram.UseProgram();
+    const std::chrono::steady_clock::time_point shaderStart = std::chrono::steady_clock::now();
+    if (!InitGlShaders()) {
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
+    std::cout << "Shaders and buffers initialized in "
+              << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shaderStart).count() << " ms";
+    if (programBinaryCache.IsEnabled()) {
+        std::cout << ", " << programBinaryCache.GetHitCount() << " from the binary cache, "
+                  << programBinaryCache.GetMissCount() << " compiled";
+    }
+    std::cout << std::endl;
+    glslProgram->UseProgram();
 
-    std::string s = glslProgram.ToString();
+    std::string s = glslProgram->ToString();
     std::cout << s << std::endl;
 
-    while (!glfwWindowShouldClose(window))
-    {
-        // Check if any events have been activated (key pressed, mouse moved etc.) and call corresponding
-        // response functions.
-        glfwPollEvents();
+    gpuTimer.Create();
 
-        Render(window);
+    if (options.hotReload && !programBuilder.Create(window)) {
+        std::cerr << "Hot reload is off: shaders can't be rebuilt in the background" << std::endl;
+        options.hotReload = false;
     }
 
+    if (options.windowCount > 1 && !StartSharedWindows(window)) {
+        StopSharedWindows();
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
+
+    if (options.updateRate > 0) {
+        StartUpdateThread();
+    }
+
+    bool success = true;
+    if (options.benchmarkFrames > 0) {
+        success = RunBenchmark(window);
+    }
+    else if (options.bakeFrames > 0) {
+        success = RunBake(window);
+    }
+    else {
+        while (!glfwWindowShouldClose(window) && !IsAnySharedWindowClosing())
+        {
+            // Check if any events have been activated (key pressed, mouse moved etc.) and call corresponding
+            // response functions.
+            const std::chrono::steady_clock::time_point pollStart = std::chrono::steady_clock::now();
+            glfwPollEvents();
+            pollTimes.Add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pollStart).count());
+
+            Render(window);
+
+            ReportTimings(window);
+
+            if (options.hotReload) {
+                UpdateShaderReload();
+            }
+        }
+    }
+
+    StopUpdateThread();
+    StopSharedWindows();
+
     // Deallocate all resources once they've outlived their purpose.
     glUseProgram(0);
-    glslProgram.DeleteProgram();
+    gpuTimer.Delete();
+    programBuilder.Destroy();
+    shaderVariants.Delete();
+    frameUniformBuffer.Delete();
+    rippleEmitters.Delete();
+    surfaceInstances.Delete();
+    if (options.readbackMode != ReadbackMode::None) {
+        std::cout << "Readback: " << asyncReadback.GetDeliveredCount() << " reads delivered, waited for a free slot "
+                  << asyncReadback.GetStallCount() << " times" << std::endl;
+    }
+    asyncReadback.Delete();
+    computeDeformer.Delete();
+    transformFeedbackDeformer.Delete();
+    if (options.deformPath == DeformPath::Simulation && !options.playbackInput.empty()) {
+        std::cout << "Playback: " << bakePlayer.GetUploadCount() << " frames uploaded, "
+                  << bakePlayer.GetUploadedBytes() / 1.0e6 << " MB read from the bake" << std::endl;
+        bakePlayer.Close();
+    }
+    else if (options.deformPath == DeformPath::Simulation) {
+        std::cout << "Simulation: " << waveSimulation.GetStepCount() << " steps, "
+                  << waveSimulation.GetSkippedStepCount() << " skipped" << std::endl;
+        waveSimulation.Delete();
+    }
+    if (options.deformPath == DeformPath::Cpu) {
+        std::cout << "Streaming: waited for the GPU " << streamingVertexBuffer.GetWaitCount() << " times" << std::endl;
+        streamingVertexBuffer.Delete();
+    }
     glDeleteVertexArrays(1, &vaoId);
     glDeleteBuffers(1, &vboVerticesId);
     glDeleteBuffers(1, &vboIndicesId);
@@ -126,132 +449,1264 @@ int main(int argc, const char* argv[])
     // Terminate GLFW, clearing any resources allocated by GLFW.
     glfwTerminate();
 
-    return EXIT_SUCCESS;
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * Checks that the context supports the selected modes.
+ */
+bool CheckGlRequirements()
+{
+    if (!GLEW_VERSION_4_3) {
+        if (options.emitterCount > 0) {
+            std::cerr << "Ripple emitters need OpenGL 4.3 shader storage buffers" << std::endl;
+            return false;
+        }
+        if (options.deformPath == DeformPath::Compute) {
+            std::cerr << "The compute deformation pass needs OpenGL 4.3 compute shaders" << std::endl;
+            return false;
+        }
+    }
+    if (!GLEW_VERSION_4_3 && options.deformPath == DeformPath::Simulation && options.playbackInput.empty()) {
+        std::cerr << "The wave simulation needs OpenGL 4.3 compute shaders" << std::endl;
+        return false;
+    }
+    if (!GLEW_VERSION_4_0 && options.deformPath == DeformPath::Tessellation) {
+        std::cerr << "Tessellation needs OpenGL 4.0" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool InitMesh()
+{
+    if (options.meshSource == MeshSource::Procedural) {
+        // Nothing to generate; the vertex shader rebuilds the grid from the vertex and instance IDs.
+        std::cout << "Mesh: " << options.quadsX << "x" << options.quadsZ << " quads, procedural" << std::endl;
+        return true;
+    }
+
+    if (options.meshSource == MeshSource::Patches) {
+        if (!lodPatches.Init(options.patchesX, options.patchesZ, options.patchesX * LOD_PATCH_SIZE,
+                             options.patchesZ * LOD_PATCH_SIZE, LOD_DISTANCE)) {
+            return false;
+        }
+        lodPatches.SetFlatDistance(options.farFieldEnd);
+        std::cout << "Mesh: " << options.patchesX << "x" << options.patchesZ << " patches of "
+                  << LodPatches::PATCH_QUADS << "x" << LodPatches::PATCH_QUADS << " quads, "
+                  << lodPatches.GetFullResolutionTriangleCount() << " triangles at full resolution, "
+                  << lodPatches.GetIndexDataSize() / sizeof(GLushort) << " indices for all levels" << std::endl;
+        return true;
+    }
+
+    // Tessellation draws each quad as one patch.
+    const IndexLayout layout = options.deformPath == DeformPath::Tessellation ? IndexLayout::Patches : options.indexLayout;
+    if (!gridMesh.Generate(options.quadsX, options.quadsZ, SIZE_X, SIZE_Z, layout, options.vertexFormat)) {
+        return false;
+    }
+
+    std::cout << "Mesh: " << gridMesh.GetQuadsX() << "x" << gridMesh.GetQuadsZ() << " quads, "
+              << gridMesh.GetVertexCount() << " vertices, " << gridMesh.GetIndexCount() << " "
+              << (gridMesh.GetIndexType() == GL_UNSIGNED_INT ? "32" : "16") << "-bit indices as "
+              << (gridMesh.GetIndexLayout() == IndexLayout::Strips ? "strips"
+                  : gridMesh.GetIndexLayout() == IndexLayout::Patches ? "patches" : "triangles") << ", "
+              << gridMesh.GetVertexDataSize() / gridMesh.GetVertexCount() << " bytes per vertex" << std::endl;
+
+    // Optionally reorder the quads for the post-transform vertex cache and report the gain.
+    double acmr = gridMesh.ComputeAcmr(options.vertexCacheSize);
+    if (options.quadOrder != QuadOrder::RowMajor) {
+        if (!gridMesh.Reorder(options.quadOrder, options.vertexCacheSize)) {
+            return false;
+        }
+        std::cout << "ACMR (" << options.vertexCacheSize << " entry FIFO): " << acmr << " row-major, "
+                  << gridMesh.ComputeAcmr(options.vertexCacheSize) << " reordered" << std::endl;
+    }
+    else if (options.cullTileQuads > 0) {
+        if (!gridMesh.SplitIntoTiles(options.cullTileQuads)) {
+            return false;
+        }
+        std::cout << "Culling tiles: " << gridMesh.GetTiles().size() << " of up to " << options.cullTileQuads << "x"
+                  << options.cullTileQuads << " quads, ACMR (" << options.vertexCacheSize << " entry FIFO): " << acmr
+                  << " row-major, " << gridMesh.ComputeAcmr(options.vertexCacheSize) << " tiled" << std::endl;
+    }
+    else {
+        std::cout << "ACMR (" << options.vertexCacheSize << " entry FIFO): " << acmr << std::endl;
+    }
+
+    return true;
 }
 
-void InitMesh()
+/**
+ * Times the CPU deformer with every kernel this build and CPU can run, and prints the throughput.
+ */
+bool RunCpuBenchmark()
 {
-    unsigned int index = 0;
-    int i=0, j=0;
+    const unsigned long long vertexCount = static_cast<unsigned long long>(options.quadsX + 1) * (options.quadsZ + 1);
+    cpuDeformer.Init(options.quadsX, options.quadsZ, SIZE_X, SIZE_Z);
+    ThreadPool threadPool(static_cast<unsigned int>(options.threadCount));
 
-    // Create the plane vertices.
-    for (j = 0; j <= NBR_OF_QUADS_Z; ++j) {
-        for (i = 0; i <= NBR_OF_QUADS_X; ++i) {
-            vertices[index++] = glm::vec3(
-                ((static_cast<float>(i) / (NBR_OF_QUADS_X - 1)) * 2 - 1) * HALF_SIZE_X,
-                0,
-                ((static_cast<float>(j) / (NBR_OF_QUADS_Z - 1)) * 2 - 1) * HALF_SIZE_Z);
+    std::cout << "CPU deformer: " << options.quadsX << "x" << options.quadsZ << " quads, " << vertexCount
+              << " vertices, " << options.cpuBenchmarkFrames << " frames, " << threadPool.GetThreadCount()
+              << " threads" << std::endl;
+
+    FrameUniforms benchmarkUniforms = FrameUniforms();
+    benchmarkUniforms.amplitude = RIPPLE_AMPLITUDE;
+    benchmarkUniforms.frequency = RIPPLE_FREQUENCY;
+
+    // The scalar kernel is the reference the others are checked against.
+    cpuDeformer.SetKernel(SimdKernel::Scalar);
+    cpuDeformer.Deform(benchmarkUniforms, &threadPool);
+    const std::vector<float> referenceHeights = cpuDeformer.GetHeights();
+
+    const SimdKernel kernels[] = { SimdKernel::Scalar, SimdKernel::Sse2, SimdKernel::Avx2, SimdKernel::Neon };
+    for (size_t kernelIndex = 0; kernelIndex < sizeof(kernels) / sizeof(kernels[0]); ++kernelIndex) {
+        if (!cpuDeformer.SetKernel(kernels[kernelIndex])) {
+            continue;
         }
+
+        // One untimed frame warms up the caches and the worker threads.
+        cpuDeformer.Deform(benchmarkUniforms, &threadPool);
+
+        float maxError = 0.0f;
+        for (size_t index = 0; index < referenceHeights.size(); ++index) {
+            maxError = std::max(maxError, std::fabs(cpuDeformer.GetHeights()[index] - referenceHeights[index]));
+        }
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < options.cpuBenchmarkFrames; ++frame) {
+            benchmarkUniforms.waveTime = std::sin(frame / 60.0f) * RIPPLE_DISPLACEMENT_SPEED;
+            cpuDeformer.Deform(benchmarkUniforms, &threadPool);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "  " << CpuDeformer::GetKernelName(kernels[kernelIndex]) << ": "
+                  << seconds * 1000.0 / options.cpuBenchmarkFrames << " ms/frame, "
+                  << vertexCount * options.cpuBenchmarkFrames / seconds / 1.0e6 << " Mvertices/s, max error "
+                  << maxError << std::endl;
     }
 
-    // Fill the plane indices array.
-    GLushort* id = &indices[0];
-    for (i = 0; i < NBR_OF_QUADS_Z; ++i) {
-        for (j = 0; j < NBR_OF_QUADS_X; ++j) {
-            int i0 = i * (NBR_OF_QUADS_X + 1) + j;
-            int i1 = i0 + 1;
-            int i2 = i0 + (NBR_OF_QUADS_X + 1);
-            int i3 = i2 + 1;
+    return true;
+}
 
-            if ((j + i) % 2) {
-                *id++ = i0;
-                *id++ = i2;
-                *id++ = i1;
-                *id++ = i1;
-                *id++ = i2;
-                *id++ = i3;
+/**
+ * Runs options.cpuSimulationFrames frames of the wave equation of --deform simulation on the CPU wave
+ * solver, with the same drops, and writes the heights of every frame to the bake file options.bakeOutput.
+ * Reports the step rate and how close the solver's memory traffic comes to the machine's copy bandwidth.
+ */
+bool RunCpuSimulation()
+{
+    ThreadPool threadPool(static_cast<unsigned int>(options.threadCount));
+    CpuWaveSolver solver;
+    solver.Init(options.quadsX, options.quadsZ, SIZE_X, SIZE_Z, options.simulationRate, SIMULATION_DAMPING);
+    const unsigned long long pointCount = static_cast<unsigned long long>(solver.GetColumns()) * solver.GetRows();
+
+    BakeWriter bakeWriter;
+    if (!options.bakeOutput.empty()
+            && !bakeWriter.Open(options.bakeOutput, solver.GetColumns(), solver.GetRows(), SIZE_X, SIZE_Z, BAKE_FRAME_RATE,
+                                options.bakeEncoding)) {
+        return false;
+    }
+
+    std::cout << "CPU wave solver: " << solver.GetColumns() << "x" << solver.GetRows() << " points, "
+              << options.cpuSimulationFrames << " frames at " << options.simulationRate << " steps/s, time block "
+              << options.timeBlock << ", " << threadPool.GetThreadCount() << " threads" << std::endl;
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> x(-SIZE_X / 2.0f, SIZE_X / 2.0f), z(-SIZE_Z / 2.0f, SIZE_Z / 2.0f);
+    double nextDrop = 0.0;
+    double solveSeconds = 0.0;
+    double writeSeconds = 0.0;
+
+    for (int frame = 0; frame < options.cpuSimulationFrames; ++frame) {
+        const double frameTime = static_cast<double>(frame) / BAKE_FRAME_RATE;
+        for (; nextDrop <= frameTime; nextDrop += DROP_INTERVAL) {
+            solver.AddDrop(glm::vec2(x(generator), z(generator)), DROP_RADIUS, DROP_HEIGHT);
+        }
+
+        // The steps due by the end of the frame; whole numbers, so no step is lost to rounding.
+        const unsigned long long stepsDue =
+                static_cast<unsigned long long>(frame + 1) * options.simulationRate / BAKE_FRAME_RATE;
+        const std::chrono::steady_clock::time_point solveStart = std::chrono::steady_clock::now();
+        solver.Run(static_cast<int>(stepsDue - solver.GetStepCount()), options.timeBlock, &threadPool);
+        solveSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - solveStart).count();
+
+        if (bakeWriter.IsOpen()) {
+            const std::chrono::steady_clock::time_point writeStart = std::chrono::steady_clock::now();
+            const bool isWritten = bakeWriter.WriteFrame(solver.GetHeights().data());
+            writeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStart).count();
+            if (!isWritten) {
+                return false;
             }
-            else {
-                *id++ = i0;
-                *id++ = i2;
-                *id++ = i3;
-                *id++ = i0;
-                *id++ = i3;
-                *id++ = i1;
+        }
+    }
+    if (!bakeWriter.Close()) {
+        return false;
+    }
+
+    const unsigned long long stepCount = solver.GetStepCount();
+    const double trafficBandwidth = solver.GetGridTrafficBytes() / solveSeconds;
+    const double copyBandwidth = CpuWaveSolver::MeasureCopyBandwidth(&threadPool);
+    const double bandwidthShare = trafficBandwidth / copyBandwidth;
+
+    std::cout << "  " << stepCount << " steps in " << solveSeconds << " s: " << solveSeconds * 1000.0 / stepCount
+              << " ms/step, " << pointCount * stepCount / solveSeconds / 1.0e6 << " Mpoints/s, "
+              << (static_cast<double>(solver.GetComputedPointCount()) / (pointCount * stepCount) - 1.0) * 100.0
+              << "% recomputed in halos" << std::endl;
+    std::cout << "  grid traffic " << trafficBandwidth / 1.0e9 << " GB/s of " << copyBandwidth / 1.0e9
+              << " GB/s copy bandwidth (" << bandwidthShare * 100.0 << "%): "
+              << (bandwidthShare > BANDWIDTH_BOUND_SHARE ? "bandwidth-bound" : "compute-bound") << std::endl;
+    if (!options.bakeOutput.empty()) {
+        std::cout << "  wrote " << bakeWriter.GetFrameCount() << " " << GetOptionName(options.bakeEncoding) << " frames, "
+                  << bakeWriter.GetFileBytes() / 1.0e6 << " MB, to " << options.bakeOutput << " in " << writeSeconds
+                  << " s" << std::endl;
+    }
+
+    return true;
+}
+
+/**
+ * Renders options.benchmarkFrames frames into an offscreen framebuffer, as fast as the GPU allows, and
+ * writes the frame times with the configuration to the benchmark output.
+ */
+bool RunBenchmark(GLFWwindow* window)
+{
+    // Render into a framebuffer object of the window's size; the hidden window's own framebuffer may
+    // not be backed by anything, and its swaps are no longer tied to the display.
+    GLuint framebufferId, colorRenderbufferId, depthRenderbufferId;
+    glGenFramebuffers(1, &framebufferId);
+    glGenRenderbuffers(1, &colorRenderbufferId);
+    glGenRenderbuffers(1, &depthRenderbufferId);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, colorRenderbufferId);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, WIDTH, HEIGHT);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbufferId);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, WIDTH, HEIGHT);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderbufferId);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderbufferId);
+
+    bool success = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (!success) {
+        std::cerr << "RunBenchmark: Incomplete framebuffer" << std::endl;
+    }
+    else {
+        glViewport(0, 0, WIDTH, HEIGHT);
+        projectionMatrix = glm::perspective(45.0f, static_cast<GLfloat>(WIDTH) / HEIGHT, 1.0f, 1000.0f);
+
+        for (int frame = 0; frame < BENCHMARK_WARMUP_FRAMES; ++frame) {
+            glfwPollEvents();
+            Render(window);
+        }
+        glFinish();
+        gpuTimes.Clear();
+
+        // Whole frames, from one poll to the next, with the last frame's GPU work included. The warm-up
+        // frames have sized every buffer, so from here on the frames shouldn't touch the heap.
+        RollingStats frameTimes(static_cast<size_t>(options.benchmarkFrames));
+        const AllocationCount allocationsBefore = GetAllocationCount();
+        std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < options.benchmarkFrames; ++frame) {
+            glfwPollEvents();
+            Render(window);
+            if (frame + 1 == options.benchmarkFrames) {
+                glFinish();
+            }
+
+            const std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+            frameTimes.Add(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+            frameStart = frameEnd;
+        }
+        const AllocationCount allocationsAfter = GetAllocationCount();
+
+        BenchmarkResult result;
+        result.quadsX = options.quadsX;
+        result.quadsZ = options.quadsZ;
+        result.meshSource = options.meshSource;
+        result.indexLayout = options.meshSource == MeshSource::Indexed ? gridMesh.GetIndexLayout() : options.indexLayout;
+        result.vertexFormat = options.vertexFormat;
+        result.deformPath = options.deformPath;
+        result.shading = options.shading;
+        result.farFieldStart = options.farFieldStart;
+        result.farFieldEnd = options.farFieldEnd;
+        result.emitterCount = options.emitterCount;
+        result.instanceCount = options.instanceCount;
+        result.cullTileQuads = options.cullTileQuads;
+        result.vertexCount = static_cast<unsigned long long>(options.quadsX + 1) * (options.quadsZ + 1)
+                             * std::max(options.instanceCount, 1);
+        if (options.meshSource == MeshSource::Patches) {
+            result.quadsX = options.patchesX * LodPatches::PATCH_QUADS;
+            result.quadsZ = options.patchesZ * LodPatches::PATCH_QUADS;
+            result.vertexCount = 3 * lodPatches.GetTriangleCount();
+        }
+        result.frames = options.benchmarkFrames;
+        result.averageMilliseconds = frameTimes.GetAverage();
+        result.percentile99Milliseconds = frameTimes.GetPercentile99();
+        result.gpuAverageMilliseconds = gpuTimes.GetAverage();
+        result.bufferBytes = GetBufferBytes();
+        result.renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+
+        success = WriteBenchmarkResult(result, options.benchmarkOutput, options.benchmarkFormat);
+
+        if (options.checkAllocations) {
+            const unsigned long long allocations = allocationsAfter.allocations - allocationsBefore.allocations;
+            std::cout << "Allocations: " << allocations << ", " << allocationsAfter.bytes - allocationsBefore.bytes
+                      << " bytes, in " << options.benchmarkFrames << " frames" << std::endl;
+            if (allocations > 0) {
+                std::cerr << "RunBenchmark: The render loop allocated from the heap" << std::endl;
+                success = false;
             }
         }
     }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteRenderbuffers(1, &depthRenderbufferId);
+    glDeleteRenderbuffers(1, &colorRenderbufferId);
+    glDeleteFramebuffers(1, &framebufferId);
+
+    return success;
 }
 
-void Render(GLFWwindow* window)
+/**
+ * Renders options.bakeFrames frames on a BAKE_FRAME_RATE clock, reads the heights of every frame back from
+ * the deformation's buffer or texture and writes them to the bake file options.bakeOutput. The reads are
+ * asynchronous: a frame is written once its read arrives, a few frames later, while the GPU goes on.
+ */
+bool RunBake(GLFWwindow* window)
 {
-    // Calculate the MVP matrix: model maps from an object's local coordinate space into world space,
-    // view from world space to camera space, projection from camera to screen.
-    glm::mat4 T	 = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, distance));
-    glm::mat4 Rx = glm::rotate(T,  rX, glm::vec3(1.0f, 0.0f, 0.0f));
-    glm::mat4 MV = glm::rotate(Rx, rY, glm::vec3(0.0f, 1.0f, 0.0f));
-    glm::mat4 modelViewProjectMatrix = projectionMatrix * MV;
+    BakeWriter bakeWriter;
+    if (!bakeWriter.Open(options.bakeOutput, gridMesh.GetQuadsX() + 1, gridMesh.GetQuadsZ() + 1, SIZE_X, SIZE_Z,
+                         BAKE_FRAME_RATE, options.bakeEncoding)) {
+        return false;
+    }
 
-    glBindVertexArray(vaoId);
+    // Reads are delivered in order, so the frames arrive in order too.
+    bool isWritten = true;
+    const std::function<void(const float*, size_t)> writeFrame = [&](const float* heights, size_t count) {
+        isWritten = isWritten && bakeWriter.WriteFrame(heights);
+    };
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (bakeFrame = 0; bakeFrame < options.bakeFrames && isWritten; ++bakeFrame) {
+        glfwPollEvents();
+        Render(window);
+        QueueHeightsReadback(writeFrame);
+    }
+    asyncReadback.Finish();
+    if (!isWritten || !bakeWriter.Close()) {
+        return false;
+    }
+
+    std::cout << "Baked " << bakeWriter.GetFrameCount() << " " << GetOptionName(options.bakeEncoding) << " frames, "
+              << bakeWriter.GetFileBytes() / 1.0e6 << " MB, to " << options.bakeOutput << " in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+              << " s; waited for a free readback slot " << asyncReadback.GetStallCount() << " times" << std::endl;
+    return true;
+}
+
+/**
+ * Queues this frame's read for --readback: the heights, or the pixels of the bound framebuffer's
+ * viewport. The results update the range or checksum shown by the timing report when they arrive.
+ */
+void QueueReadback()
+{
+    if (options.readbackMode == ReadbackMode::Heights) {
+        static const std::function<void(const float*, size_t)> updateHeightRange = [](const float* heights, size_t count) {
+            const std::pair<const float*, const float*> range = std::minmax_element(heights, heights + count);
+            readbackHeightRange = glm::vec2(*range.first, *range.second);
+        };
+        QueueHeightsReadback(updateHeightRange);
+    }
+    else if (options.readbackMode == ReadbackMode::Pixels) {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        asyncReadback.ReadPixels(viewport[0], viewport[1], viewport[2], viewport[3], [](const void* data, size_t bytes) {
+            // 64-bit FNV-1a of a sample of the RGBA pixels, enough to tell two frames apart.
+            const unsigned char* pixels = static_cast<const unsigned char*>(data);
+            const size_t pixelCount = bytes / 4;
+            const size_t stride = std::max<size_t>(pixelCount / CHECKSUM_SAMPLE_COUNT, 1);
+            uint64_t hash = 14695981039346656037ULL;
+            for (size_t pixel = 0; pixel < pixelCount; pixel += stride) {
+                for (size_t channel = 0; channel < 4; ++channel) {
+                    hash = (hash ^ pixels[pixel * 4 + channel]) * 1099511628211ULL;
+                }
+            }
+            readbackChecksum = hash;
+        });
+    }
+}
+
+/**
+ * Queues a read of the heights of the last deformation, one per grid point in GridMesh vertex order,
+ * for a callback: from the simulation's or the bake's height texture, or out of the deformed vertices.
+ * The read only keeps a reference to the callback, so that queuing it doesn't allocate; the callback
+ * has to outlive the read.
+ */
+void QueueHeightsReadback(const std::function<void(const float* heights, size_t count)>& callback)
+{
+    const size_t count = static_cast<size_t>(gridMesh.GetQuadsX() + 1) * (gridMesh.GetQuadsZ() + 1);
+
+    if (options.deformPath == DeformPath::Simulation) {
+        // The simulation writes its heights with image stores.
+        GLuint heightTextureId = bakePlayer.GetHeightTextureId();
+        if (options.playbackInput.empty()) {
+            glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+            heightTextureId = waveSimulation.GetHeightTextureId();
+        }
+        asyncReadback.ReadTexture(heightTextureId, GL_RED, GL_FLOAT, static_cast<GLsizeiptr>(count * sizeof(float)),
+                                  [&callback](const void* data, size_t bytes) {
+            callback(static_cast<const float*>(data), bytes / sizeof(float));
+        });
+        return;
+    }
+
+    // The compute deformer writes its vertices with storage buffer stores.
+    GLuint bufferId = transformFeedbackDeformer.GetBufferId();
+    if (options.deformPath == DeformPath::Compute) {
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        bufferId = computeDeformer.GetBufferId();
+    }
+    asyncReadback.ReadBuffer(bufferId, 0, static_cast<GLsizeiptr>(count * sizeof(DeformedVertex)),
+                             [&callback](const void* data, size_t bytes) {
+        const DeformedVertex* vertices = static_cast<const DeformedVertex*>(data);
+        readbackHeights.resize(bytes / sizeof(DeformedVertex));
+        for (size_t index = 0; index < readbackHeights.size(); ++index) {
+            readbackHeights[index] = vertices[index].position.y;
+        }
+        callback(readbackHeights.data(), readbackHeights.size());
+    });
+}
+
+/**
+ * Adds up the sizes of the buffers allocated for the mesh and its deformation. Drivers don't report
+ * what a buffer really occupies in VRAM, so this is an estimate of the footprint of a configuration.
+ */
+long long GetBufferBytes()
+{
+    const long long vertexCount = static_cast<long long>(options.quadsX + 1) * (options.quadsZ + 1);
+    long long bytes = sizeof(FrameUniforms);
+
+    if (options.meshSource == MeshSource::Patches) {
+        return bytes + lodPatches.GetVertexDataSize() + lodPatches.GetIndexDataSize();
+    }
+    if (options.meshSource == MeshSource::Procedural) {
+        return bytes;
+    }
 
-    glUniformMatrix4fv(
-            glslProgram.GetUniformLocation("modelViewProjectMatrix"),
-            1,
-            GL_FALSE,
-            glm::value_ptr(modelViewProjectMatrix));
+    bytes += gridMesh.GetIndexDataSize();
+    if (options.deformPath == DeformPath::Compute) {
+        bytes += vertexCount * static_cast<long long>(sizeof(DeformedVertex));
+    }
+    else if (options.deformPath == DeformPath::TransformFeedback) {
+        bytes += gridMesh.GetVertexDataSize() + vertexCount * static_cast<long long>(sizeof(DeformedVertex));
+    }
+    else if (options.deformPath == DeformPath::Simulation) {
+        bytes += gridMesh.GetVertexDataSize()
+                 + (options.playbackInput.empty() ? waveSimulation.GetTextureBytes() : bakePlayer.GetTextureBytes());
+    }
+    else if (options.deformPath == DeformPath::Cpu) {
+        bytes += StreamingVertexBuffer::REGION_COUNT * vertexCount * static_cast<long long>(sizeof(glm::vec3));
+    }
+    else {
+        bytes += gridMesh.GetVertexDataSize();
+    }
+
+    bytes += static_cast<long long>(rippleEmitters.GetEmitters().size() * sizeof(RippleEmitter));
+    bytes += static_cast<long long>(surfaceInstances.GetCount()) * static_cast<long long>(sizeof(SurfaceInstance));
+    return bytes;
+}
+
+/**
+ * Produces the simulation state for a time: the camera, the ripple parameters and, if asked to, the
+ * grid deformed on the CPU. Reads nothing Render() writes, and the camera input only through its
+ * atomics, so it can run on the update thread.
+ */
+void UpdateFrameState(FrameState& state, double time, bool deformOnCpu)
+{
+    // Calculate the model-view matrix: model maps from an object's local coordinate space into world
+    // space, view from world space to camera space.
+    glm::mat4 T	 = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, distance.load()));
+    glm::mat4 Rx = glm::rotate(T,  rX.load(), glm::vec3(1.0f, 0.0f, 0.0f));
+    glm::mat4 MV = glm::rotate(Rx, rY.load(), glm::vec3(0.0f, 1.0f, 0.0f));
+    state.modelViewMatrix = MV;
 
-    GLfloat elapsedTime = glfwGetTime();
+    // The camera sits at the view space origin.
+    state.cameraPosition = glm::vec3(glm::inverse(MV)[3]);
+
+    GLfloat elapsedTime = static_cast<GLfloat>(time);
 
     //GLfloat green = (sin(elapsedTime) / 2) + 0.5; // 0 - 1.0
     GLfloat green = 1.0f;
-    glUniform4f(glslProgram.GetUniformLocation("newColor"), 0.0f, green, 0.0f, 1.0f);
+    state.uniforms.newColor = glm::vec4(0.0f, green, 0.0f, 1.0f);
 
     GLfloat rippleDisplacement = (sin(elapsedTime)) * RIPPLE_DISPLACEMENT_SPEED;
-    glUniform1f(glslProgram.GetUniformLocation("waveTime"), rippleDisplacement);
+    state.uniforms.waveTime = rippleDisplacement;
+    state.uniforms.waveCenter = glm::vec2(0.0f, 0.0f);
+    state.uniforms.amplitude = RIPPLE_AMPLITUDE;
+    state.uniforms.frequency = RIPPLE_FREQUENCY;
+
+    state.time = time;
+
+    if (deformOnCpu) {
+        // Only allocates the first time each slot of the triple buffer is filled.
+        state.positions.resize(cpuDeformer.GetVertexCount());
+        cpuDeformer.Deform(state.uniforms, threadPool.get(), state.positions.data());
+    }
+}
+
+/**
+ * Publishes a first state, so Render() never sees an empty one, and starts the update thread.
+ */
+void StartUpdateThread()
+{
+    FrameState& state = frameStates.GetWriteSlot();
+    UpdateFrameState(state, glfwGetTime(), options.deformPath == DeformPath::Cpu);
+    state.step = 0;
+    frameStates.Publish();
+
+    isUpdateThreadRunning = true;
+    updateThread = std::thread(RunUpdateThread);
+
+    std::cout << "Update thread: " << options.updateRate << " fixed steps per second" << std::endl;
+}
+
+void StopUpdateThread()
+{
+    if (isUpdateThreadRunning) {
+        isUpdateThreadRunning = false;
+        updateThread.join();
+    }
+}
+
+/**
+ * The update thread: steps the simulation at options.updateRate, independently of how long frames take
+ * to render, and publishes every step's state to Render() through the triple buffer.
+ */
+void RunUpdateThread()
+{
+    const bool deformOnCpu = options.deformPath == DeformPath::Cpu;
+    const double stepSeconds = 1.0 / options.updateRate;
+    const std::chrono::duration<double> stepDuration(stepSeconds);
+
+    const double startTime = glfwGetTime();
+    std::chrono::steady_clock::time_point nextUpdate = std::chrono::steady_clock::now();
+    unsigned long long step = 1;
+
+    while (isUpdateThreadRunning) {
+        nextUpdate += std::chrono::duration_cast<std::chrono::steady_clock::duration>(stepDuration);
+        std::this_thread::sleep_until(nextUpdate);
+
+        FrameState& state = frameStates.GetWriteSlot();
+        UpdateFrameState(state, startTime + step * stepSeconds, deformOnCpu);
+        state.step = step;
+        frameStates.Publish();
+        ++step;
+
+        // When a step takes longer than the step time, skip the missed steps rather than run them back
+        // to back; the simulation time stays on the fixed grid of steps.
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now - nextUpdate > stepDuration) {
+            const unsigned long long missedSteps = static_cast<unsigned long long>((now - nextUpdate) / stepDuration);
+            step += missedSteps;
+            nextUpdate += std::chrono::duration_cast<std::chrono::steady_clock::duration>(stepDuration * static_cast<double>(missedSteps));
+        }
+    }
+}
+
+void Render(GLFWwindow* window)
+{
+    // Time everything up to the swap, on the CPU and on the GPU.
+    const std::chrono::steady_clock::time_point renderStart = std::chrono::steady_clock::now();
+    gpuTimer.Begin();
+
+    // Take the latest state of the update thread, or produce this frame's state here.
+    const FrameState* state = &renderFrameState;
+    if (isUpdateThreadRunning) {
+        state = &frameStates.Acquire();
+    }
+    else {
+        // A bake samples the animation on its own clock, however long a frame takes.
+        const double time = options.bakeFrames > 0 ? static_cast<double>(bakeFrame) / BAKE_FRAME_RATE : glfwGetTime();
+        UpdateFrameState(renderFrameState, time, false);
+    }
+
+    // Projection maps from camera to screen.
+    frameUniforms = state->uniforms;
+    frameUniforms.modelViewProjectMatrix = projectionMatrix * state->modelViewMatrix;
+
+    if (options.meshSource == MeshSource::Patches) {
+        lodPatches.SelectLevels(state->cameraPosition);
+    }
+    if (options.farFieldEnd > 0.0f) {
+        cameraPositionUniform.Set(state->cameraPosition);
+    }
+
+    // Upload all of the frame's uniforms in one buffer write.
+    frameUniformBuffer.Update(frameUniforms);
+
+    if (!sharedWindows.empty()) {
+        SharedFrame sharedFrame;
+        sharedFrame.uniforms = frameUniforms;
+        sharedFrame.modelViewMatrix = state->modelViewMatrix;
+        sharedFrame.programId = glslProgram->GetHandle();
+        for (size_t index = 0; index < sharedWindows.size(); ++index) {
+            sharedWindows[index]->Publish(sharedFrame);
+        }
+    }
+
+    // Deform the grid once for the frame; the draws below only read the result.
+    if (options.deformPath == DeformPath::Compute) {
+        computeDeformer.Deform();
+        glslProgram->UseProgram();
+    }
+    else if (options.deformPath == DeformPath::TransformFeedback) {
+        transformFeedbackDeformer.Deform();
+        glslProgram->UseProgram();
+    }
+    else if (options.deformPath == DeformPath::Simulation) {
+        double simulationTime = state->time;
+        if (options.benchmarkFrames > 0 || options.bakeFrames > 0) {
+            benchmarkSimulationTime += BENCHMARK_SIMULATION_FRAME_TIME;
+            simulationTime = benchmarkSimulationTime;
+        }
+
+        GLuint heightTextureId;
+        if (!options.playbackInput.empty()) {
+            // Play the bake on the clock the simulation would have run on.
+            bakePlayer.ShowFrameAt(simulationTime);
+            heightTextureId = bakePlayer.GetHeightTextureId();
+        }
+        else {
+            // Queue the drops due by now, then run the steps due by now.
+            if (nextDropTime < 0.0) {
+                nextDropTime = simulationTime;
+            }
+            std::uniform_real_distribution<float> x(-SIZE_X / 2.0f, SIZE_X / 2.0f), z(-SIZE_Z / 2.0f, SIZE_Z / 2.0f);
+            for (; nextDropTime <= simulationTime; nextDropTime += DROP_INTERVAL) {
+                waveSimulation.AddDrop(glm::vec2(x(dropGenerator), z(dropGenerator)), DROP_RADIUS, DROP_HEIGHT);
+            }
+
+            waveSimulation.Advance(simulationTime);
+            heightTextureId = waveSimulation.GetHeightTextureId();
+        }
+        glslProgram->UseProgram();
+        glActiveTexture(GL_TEXTURE0 + SIMULATION_HEIGHTS_UNIT);
+        glBindTexture(GL_TEXTURE_2D, heightTextureId);
+    }
+    else if (options.deformPath == DeformPath::Cpu) {
+        // Fill the next free region while the GPU may still be drawing the previous frames.
+        glm::vec3* positions = static_cast<glm::vec3*>(streamingVertexBuffer.BeginWrite());
+        if (isUpdateThreadRunning) {
+            // The update thread has deformed the grid already; only the copy is left for this thread.
+            std::memcpy(positions, state->positions.data(), state->positions.size() * sizeof(glm::vec3));
+        }
+        else {
+            cpuDeformer.Deform(frameUniforms, threadPool.get(), positions);
+        }
+        streamingVertexBuffer.EndWrite();
+    }
+
+    glBindVertexArray(vaoId);
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // Draw the mesh triangles.
-    // - first argument specifies what kind of primitive to render
-    // - second argument specifies the number of elements to render
-    // - third argument specifies the type of values in the indices
-    // - forth argument specifies a pointer to the location where the indices are stored
-    glDrawElements(GL_TRIANGLES, TOTAL_INDICES, GL_UNSIGNED_SHORT, static_cast<GLvoid*>(0));
+    if (options.meshSource == MeshSource::Procedural) {
+        // Draw one triangle strip of 2 * (quadsX + 1) vertices per row of quads, with one instance per row.
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 2 * (options.quadsX + 1), options.quadsZ);
+    }
+    else if (options.meshSource == MeshSource::Patches) {
+        const std::vector<PatchDraw>& patchDraws = lodPatches.GetPatchDraws();
+        for (size_t index = 0; index < patchDraws.size(); ++index) {
+            patchOriginUniform.Set(patchDraws[index].origin);
+            glDrawElements(GL_TRIANGLES, patchDraws[index].indexCount, GL_UNSIGNED_SHORT,
+                           reinterpret_cast<GLvoid*>(patchDraws[index].indexOffset));
+        }
+
+        if (lodPatches.GetTriangleCount() != reportedPatchTriangleCount) {
+            reportedPatchTriangleCount = lodPatches.GetTriangleCount();
+            std::cout << "Patches: " << reportedPatchTriangleCount << " triangles" << std::endl;
+        }
+    }
+    else if (options.deformPath == DeformPath::Cpu) {
+        // Draw from this frame's region: the base vertex skips the regions before it.
+        const GLint baseVertex = static_cast<GLint>(streamingVertexBuffer.GetRegionOffset() / sizeof(glm::vec3));
+        glDrawElementsBaseVertex(gridMesh.GetPrimitiveType(), gridMesh.GetIndexCount(), gridMesh.GetIndexType(),
+                                 static_cast<GLvoid*>(0), baseVertex);
+        streamingVertexBuffer.FenceRegion();
+    }
+    else {
+        // Draw the mesh triangles.
+        // - first argument specifies what kind of primitive to render (triangles or strips, depending on the layout)
+        // - second argument specifies the number of elements to render
+        // - third argument specifies the type of values in the indices (16 or 32-bit, depending on the mesh size)
+        // - forth argument specifies a pointer to the location where the indices are stored
+        if (options.instanceCount > 0) {
+            // Every surface in one call; the instance attributes advance once per surface.
+            glDrawElementsInstanced(gridMesh.GetPrimitiveType(), gridMesh.GetIndexCount(), gridMesh.GetIndexType(),
+                                    static_cast<GLvoid*>(0), surfaceInstances.GetCount());
+        }
+        else if (options.cullTileQuads > 0) {
+            tileCuller.Cull(frameUniforms.modelViewProjectMatrix);
+            glMultiDrawElements(gridMesh.GetPrimitiveType(), tileCuller.GetCounts(), gridMesh.GetIndexType(),
+                                tileCuller.GetOffsets(), tileCuller.GetVisibleTileCount());
+
+            if (tileCuller.GetVisibleTileCount() != reportedVisibleTileCount) {
+                reportedVisibleTileCount = tileCuller.GetVisibleTileCount();
+                std::cout << "Culling: " << reportedVisibleTileCount << " of " << tileCuller.GetTileCount()
+                          << " tiles visible" << std::endl;
+            }
+        }
+        else {
+            glDrawElements(gridMesh.GetPrimitiveType(), gridMesh.GetIndexCount(), gridMesh.GetIndexType(), static_cast<GLvoid*>(0));
+        }
+    }
+
+    // Queued before the swap, while the back buffer still holds the frame.
+    if (options.readbackMode != ReadbackMode::None) {
+        QueueReadback();
+    }
+
+    double gpuMilliseconds;
+    if (gpuTimer.End(gpuMilliseconds)) {
+        gpuTimes.Add(gpuMilliseconds);
+    }
+
+    const std::chrono::steady_clock::time_point swapStart = std::chrono::steady_clock::now();
+    renderTimes.Add(std::chrono::duration<double, std::milli>(swapStart - renderStart).count());
 
     glfwSwapBuffers(window);
 
+    swapTimes.Add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - swapStart).count());
+
+    // Hand over the reads of earlier frames that have finished by now.
+    asyncReadback.Poll();
+
     glBindVertexArray(0);
 }
 
-void InitGlShaders()
+// Appends printf-formatted text to the timing report, clipped to the report's buffer.
+static void AppendReport(char* report, size_t size, size_t& length, const char* format, ...)
+{
+    if (length + 1 >= size) {
+        return;
+    }
+    va_list arguments;
+    va_start(arguments, format);
+    const int written = std::vsnprintf(report + length, size - length, format, arguments);
+    va_end(arguments);
+    if (written > 0) {
+        length = std::min(length + static_cast<size_t>(written), size - 1);
+    }
+}
+
+// Appends "name min/avg/p99" of a timing to a report.
+static void AppendTiming(char* report, size_t size, size_t& length, const char* name, const RollingStats& stats)
+{
+    AppendReport(report, size, length, "%s %.2f/%.2f/%.2f", name, stats.GetMin(), stats.GetAverage(),
+                 stats.GetPercentile99());
+}
+
+/**
+ * Prints the rolling frame timings and shows them in the window title, as asked for by the options,
+ * once every TIMING_REPORT_INTERVAL seconds.
+ */
+void ReportTimings(GLFWwindow* window)
+{
+    const double now = glfwGetTime();
+    if ((!options.printTimings && !options.showTimingOverlay) || now - lastTimingReport < TIMING_REPORT_INTERVAL) {
+        return;
+    }
+    lastTimingReport = now;
+
+    // Formatted into a fixed buffer after the window title, so that reporting doesn't allocate.
+    static char title[512];
+    size_t length = 0;
+    AppendReport(title, sizeof(title), length, "Ripple Mesh Deformer - ");
+    const size_t start = length;
+    AppendReport(title, sizeof(title), length, "ms min/avg/p99: ");
+    AppendTiming(title, sizeof(title), length, "poll", pollTimes);
+    AppendReport(title, sizeof(title), length, ", ");
+    AppendTiming(title, sizeof(title), length, "render", renderTimes);
+    AppendReport(title, sizeof(title), length, ", ");
+    AppendTiming(title, sizeof(title), length, "swap", swapTimes);
+    AppendReport(title, sizeof(title), length, ", ");
+    AppendTiming(title, sizeof(title), length, "GPU", gpuTimes);
+    if (gpuTimer.GetDroppedCount() > 0) {
+        AppendReport(title, sizeof(title), length, " (%llu dropped)", gpuTimer.GetDroppedCount());
+    }
+
+    if (options.readbackMode != ReadbackMode::None) {
+        AppendReport(title, sizeof(title), length, "; readback %d frames late, ", asyncReadback.GetLastLatency());
+        if (options.readbackMode == ReadbackMode::Heights) {
+            AppendReport(title, sizeof(title), length, "heights %.3f to %.3f", readbackHeightRange.x, readbackHeightRange.y);
+        }
+        else {
+            AppendReport(title, sizeof(title), length, "checksum %llx", static_cast<unsigned long long>(readbackChecksum));
+        }
+    }
+
+    if (options.printTimings) {
+        std::cout << title + start << std::endl;
+    }
+    if (options.showTimingOverlay) {
+        glfwSetWindowTitle(window, title);
+    }
+}
+
+// A float literal for a shader #define; GLSL needs the decimal point to read it as a float.
+static std::string FormatShaderFloat(float value)
+{
+    std::ostringstream literal;
+    literal << std::showpoint << value;
+    return literal.str();
+}
+
+bool InitGlShaders()
 {
+    const bool isProcedural = options.meshSource == MeshSource::Procedural;
+    const bool isComputeDeformed = options.deformPath == DeformPath::Compute;
+    const bool isFeedbackDeformed = options.deformPath == DeformPath::TransformFeedback;
+    const bool isCpuDeformed = options.deformPath == DeformPath::Cpu;
+    const bool isTessellated = options.deformPath == DeformPath::Tessellation;
+    const bool isSimulated = options.deformPath == DeformPath::Simulation;
+
+    const char* vertexShaderPath = VERTEX_SHADER_PATH;
+    if (isProcedural) {
+        vertexShaderPath = PROCEDURAL_VERTEX_SHADER_PATH;
+    }
+    else if (options.meshSource == MeshSource::Patches) {
+        vertexShaderPath = LOD_PATCH_VERTEX_SHADER_PATH;
+    }
+    else if (isComputeDeformed || isFeedbackDeformed || isCpuDeformed) {
+        vertexShaderPath = DEFORMED_VERTEX_SHADER_PATH;
+    }
+    else if (isSimulated) {
+        vertexShaderPath = SIMULATED_VERTEX_SHADER_PATH;
+    }
+    else if (options.emitterCount > 0) {
+        vertexShaderPath = EMITTER_VERTEX_SHADER_PATH;
+    }
+    else if (isTessellated) {
+        vertexShaderPath = TESS_VERTEX_SHADER_PATH;
+    }
+    else if (options.instanceCount > 0) {
+        vertexShaderPath = INSTANCED_VERTEX_SHADER_PATH;
+    }
+
     // Load shaders and create the GLSL program.
-    glslProgram.AddShaderFromFile(GL_VERTEX_SHADER, VERTEX_SHADER_PATH);
-    glslProgram.AddShaderFromFile(GL_FRAGMENT_SHADER, FRAGMENT_SHADER_PATH);
-    glslProgram.CreateAndLinkProgram();
+    const ShaderStage vertexStage = { GL_VERTEX_SHADER, vertexShaderPath };
+    programStages.push_back(vertexStage);
+    if (isTessellated) {
+        const ShaderStage tessControlStage = { GL_TESS_CONTROL_SHADER, RIPPLE_TESS_CONTROL_SHADER_PATH };
+        const ShaderStage tessEvaluationStage = { GL_TESS_EVALUATION_SHADER, RIPPLE_TESS_EVALUATION_SHADER_PATH };
+        programStages.push_back(tessControlStage);
+        programStages.push_back(tessEvaluationStage);
+    }
+    const ShaderStage fragmentStage = { GL_FRAGMENT_SHADER, options.instanceCount > 0 ? INSTANCED_FRAGMENT_SHADER_PATH : FRAGMENT_SHADER_PATH };
+    programStages.push_back(fragmentStage);
+
+    // Specialize the shaders for the settings fixed at startup, so their branches and constants fold away.
+    // The normals for lighting come from Vertex.shader's gradient, or with the deformed vertices.
+    if (options.shading == Shading::Lit) {
+        programDefines["USE_LIGHTING"] = "1";
+    }
+    if (options.farFieldEnd > 0.0f) {
+        programDefines["USE_FAR_FIELD"] = "1";
+        programDefines["FAR_FIELD_START"] = FormatShaderFloat(options.farFieldStart);
+        programDefines["FAR_FIELD_END"] = FormatShaderFloat(options.farFieldEnd);
+    }
+    isRippleProgram = vertexShaderPath == VERTEX_SHADER_PATH;
+    if (isRippleProgram) {
+        if (options.vertexFormat == VertexFormat::Quantized) {
+            programDefines["VERTEX_FORMAT"] = "VERTEX_FORMAT_QUANTIZED";
+        }
+        programDefines["WAVE_AMPLITUDE"] = FormatShaderFloat(RIPPLE_AMPLITUDE);
+        programDefines["WAVE_FREQUENCY"] = FormatShaderFloat(RIPPLE_FREQUENCY);
+        programDefines["DAMPING"] = FormatShaderFloat(options.dampingRate);
+        programDefines["USE_DAMPING"] = options.useDamping ? "1" : "0";
+    }
+    else if (vertexShaderPath == EMITTER_VERTEX_SHADER_PATH) {
+        std::ostringstream emitterCount;
+        emitterCount << options.emitterCount;
+        programDefines["NUM_EMITTERS"] = emitterCount.str();
+        programDefines["USE_TILES"] = options.useEmitterTiles ? "1" : "0";
+    }
+
+    glslProgram = shaderVariants.Get(programStages, programDefines);
+    if (glslProgram == nullptr) {
+        return false;
+    }
+
+    if (options.hotReload) {
+        for (size_t index = 0; index < programStages.size(); ++index) {
+            shaderWatcher.AddFile(programStages[index].path);
+        }
+    }
+
+    // The per-frame uniforms come from a uniform buffer that Render() refreshes once per frame.
+    frameUniforms.waveCenter = glm::vec2(0.0f, 0.0f);
+    frameUniforms.amplitude = RIPPLE_AMPLITUDE;
+    frameUniforms.frequency = RIPPLE_FREQUENCY;
+    frameUniformBuffer.Create(sizeof(FrameUniforms), FRAME_UNIFORMS_BINDING);
+    InitProgramUniforms();
+
+    if (isProcedural) {
+        // A core profile context still needs a VAO bound to draw, even one without any attributes.
+        glGenVertexArrays(1, &vaoId);
+        return true;
+    }
+
+    if (options.meshSource == MeshSource::Patches) {
+        glGenVertexArrays(1, &vaoId);
+        glGenBuffers(1, &vboVerticesId);
+        glGenBuffers(1, &vboIndicesId);
+        glBindVertexArray(vaoId);
+
+        // The one patch grid every patch is drawn from, as 16-bit columns and rows.
+        glBindBuffer(GL_ARRAY_BUFFER, vboVerticesId);
+        glBufferData(GL_ARRAY_BUFFER, lodPatches.GetVertexDataSize(), lodPatches.GetVertexData(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_UNSIGNED_SHORT, GL_FALSE, 2 * sizeof(GLushort), (GLvoid*)0);
+        glEnableVertexAttribArray(0);
+
+        // Every level and edge variant; each patch draws one range of it.
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vboIndicesId);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, lodPatches.GetIndexDataSize(), lodPatches.GetIndexData(), GL_STATIC_DRAW);
+        return true;
+    }
+
+    if (options.emitterCount > 0) {
+        // The emitters are fixed, so their tile lists are built and uploaded once.
+        rippleEmitters.GenerateRandom(options.emitterCount, SIZE_X, SIZE_Z, 1);
+        rippleEmitters.BuildTiles(EMITTER_TILES, EMITTER_TILES, SIZE_X, SIZE_Z);
+        rippleEmitters.Upload();
 
-    // Add shader attribute and uniforms.
-    glslProgram.AddAttribute("vertex");
-    glslProgram.AddUniform("waveTime");
-    glslProgram.AddUniform("modelViewProjectMatrix");
-    glslProgram.AddUniform("newColor");
+        std::cout << "Emitters: " << options.emitterCount << ", "
+                  << (options.useEmitterTiles ? "tiled" : "naive") << " summation, "
+                  << rippleEmitters.GetAverageEmittersPerTile() << " per tile on average" << std::endl;
+    }
 
     // Create buffers.
     glGenVertexArrays(1, &vaoId);
-    glGenBuffers(1, &vboVerticesId);
     glGenBuffers(1, &vboIndicesId);
 
     // Bind the Vertex Array Object.
     glBindVertexArray(vaoId);
 
-    // Bind the Vertex Buffer Object used for the mesh's position.
-    glBindBuffer(GL_ARRAY_BUFFER, vboVerticesId);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices[0], GL_STATIC_DRAW);
-
-    // Specify how the vertex buffer data should be interpreted whenever a drawing call is made.
-    GLuint vVertexLocation = glslProgram.GetAttributeLocation("vertex");
-    glVertexAttribPointer(
-            vVertexLocation, // vertex attribute to configure
-            3,               // size of the vertex attribute; the vertex attribute is a vec3 so it is composed of 3 values
-            GL_FLOAT,        // data is GL_FLOAT (a vec* in GLSL consists of floating point values)
-            GL_FALSE,        // normalize data
-            0,               // no (zero) space between consecutive vertex attribute sets
-            (GLvoid*)0);     // offset of where position data begins in the buffer
-    glEnableVertexAttribArray(vVertexLocation);
+    // The simulated heights come from textures; the grid buffer below still provides x/z.
+    if (isSimulated && !options.playbackInput.empty()) {
+        bakePlayer.InitTexture();
+    }
+    else if (isSimulated) {
+        if (!waveSimulation.Init(WAVE_STEP_SHADER_PATH, gridMesh.GetQuadsX(), gridMesh.GetQuadsZ(), SIZE_X, SIZE_Z,
+                                 options.simulationRate, SIMULATION_DAMPING)) {
+            return false;
+        }
+        glslProgram->UseProgram();
+        std::cout << "Simulation: " << gridMesh.GetQuadsX() + 1 << "x" << gridMesh.GetQuadsZ() + 1 << " heights, "
+                  << options.simulationRate << " steps per second" << std::endl;
+    }
+
+    if (isComputeDeformed) {
+        if (!computeDeformer.Init(DEFORM_COMPUTE_SHADER_PATH, gridMesh.GetQuadsX(), gridMesh.GetQuadsZ(),
+                                  SIZE_X, SIZE_Z, FRAME_UNIFORMS_BINDING)) {
+            return false;
+        }
+
+        // Draw from the deformed vertices; the grid's own positions are never uploaded.
+        SetDeformedVertexAttributes(computeDeformer.GetBufferId());
+    }
+    else if (isFeedbackDeformed) {
+        // The grid positions only feed the capture pass, which has its own VAO.
+        glGenBuffers(1, &vboVerticesId);
+        glBindBuffer(GL_ARRAY_BUFFER, vboVerticesId);
+        glBufferData(GL_ARRAY_BUFFER, gridMesh.GetVertexDataSize(), gridMesh.GetVertexData(), GL_STATIC_DRAW);
+
+        if (!transformFeedbackDeformer.Init(CAPTURE_VERTEX_SHADER_PATH, vboVerticesId, gridMesh.GetVertexCount(),
+                                            FRAME_UNIFORMS_BINDING)) {
+            return false;
+        }
+
+        // Init() binds its own VAO, so rebind the one used for drawing.
+        glBindVertexArray(vaoId);
+        SetDeformedVertexAttributes(transformFeedbackDeformer.GetBufferId());
+    }
+    else if (isCpuDeformed) {
+        cpuDeformer.Init(gridMesh.GetQuadsX(), gridMesh.GetQuadsZ(), SIZE_X, SIZE_Z);
+        threadPool.reset(new ThreadPool(static_cast<unsigned int>(options.threadCount)));
+
+        if (!streamingVertexBuffer.Create(gridMesh.GetVertexCount() * static_cast<GLsizeiptr>(sizeof(glm::vec3)),
+                                          options.usePersistentMapping)) {
+            return false;
+        }
+        std::cout << "CPU deformer: " << CpuDeformer::GetKernelName(cpuDeformer.GetKernel()) << ", "
+                  << threadPool->GetThreadCount() << " threads, streamed by "
+                  << (streamingVertexBuffer.IsPersistentlyMapped() ? "a persistently mapped ring buffer" : "orphaning")
+                  << std::endl;
+
+        // Only positions are streamed; the normal attribute stays disabled and reads as (0, 0, 0, 1).
+        glBindBuffer(GL_ARRAY_BUFFER, streamingVertexBuffer.GetBufferId());
+        glVertexAttribPointer(DEFORMED_POSITION_LOCATION, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), static_cast<GLvoid*>(0));
+        glEnableVertexAttribArray(DEFORMED_POSITION_LOCATION);
+    }
+    else if (gridMesh.GetVertexFormat() == VertexFormat::Quantized) {
+        glslProgram->AddAttribute("gridPoint");
+        gridVertexLocation = glslProgram->GetAttributeLocation("gridPoint");
+
+        glGenBuffers(1, &vboVerticesId);
+        glBindBuffer(GL_ARRAY_BUFFER, vboVerticesId);
+        glBufferData(GL_ARRAY_BUFFER, gridMesh.GetVertexDataSize(), gridMesh.GetVertexData(), GL_STATIC_DRAW);
+        SetGridVertexAttributes();
+    }
+    else {
+        // Add shader attribute.
+        glslProgram->AddAttribute("vertex");
+        gridVertexLocation = glslProgram->GetAttributeLocation("vertex");
+
+        glGenBuffers(1, &vboVerticesId);
+
+        // Bind the Vertex Buffer Object used for the mesh's position.
+        glBindBuffer(GL_ARRAY_BUFFER, vboVerticesId);
+        glBufferData(GL_ARRAY_BUFFER, gridMesh.GetVertexDataSize(), gridMesh.GetVertexData(), GL_STATIC_DRAW);
+        SetGridVertexAttributes();
+    }
 
     // Bind the Vertex Buffer Object used for plane indices.
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vboIndicesId);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), &indices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, gridMesh.GetIndexDataSize(), gridMesh.GetIndexData(), GL_STATIC_DRAW);
+
+    if (options.instanceCount > 0) {
+        surfaceInstances.GenerateGrid(options.instanceCount, SIZE_X, SIZE_Z, 1);
+        surfaceInstances.Upload();
+        surfaceInstances.SetInstanceAttributes();
+        std::cout << "Instances: " << surfaceInstances.GetCount() << " surfaces, "
+                  << static_cast<long long>(surfaceInstances.GetCount()) * gridMesh.GetVertexCount() << " vertices per draw" << std::endl;
+    }
+
+    if (isTessellated) {
+        glPatchParameteri(GL_PATCH_VERTICES, 4);
+    }
+
+    // Strip layouts separate their rows with the largest value of the index type.
+    if (gridMesh.GetIndexLayout() == IndexLayout::Strips) {
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(gridMesh.GetRestartIndex());
+    }
+
+    if (options.cullTileQuads > 0) {
+        // No vertex can be displaced further than the sum of every amplitude that reaches it.
+        float maxHeight = RIPPLE_AMPLITUDE;
+        if (options.emitterCount > 0) {
+            maxHeight = 0.0f;
+            for (size_t index = 0; index < rippleEmitters.GetEmitters().size(); ++index) {
+                maxHeight += std::fabs(rippleEmitters.GetEmitters()[index].amplitude);
+            }
+        }
+        tileCuller.Init(gridMesh, SIZE_X, SIZE_Z, maxHeight);
+    }
+
+    return true;
+}
+
+/**
+ * Switches to the variant of Vertex.shader for the current damping setting, building it on first use.
+ */
+bool UseRippleVariant()
+{
+    programDefines["USE_DAMPING"] = options.useDamping ? "1" : "0";
+
+    GLSLProgram* program = shaderVariants.Get(programStages, programDefines);
+    if (program == nullptr) {
+        return false;
+    }
+
+    glslProgram = program;
+    InitProgramUniforms();
+
+    // A reload in progress was started with the other defines.
+    if (programBuilder.IsBuilding()) {
+        programBuilder.Build(programStages, programDefines);
+    }
+    return true;
+}
+
+/**
+ * Connects the program in use to the frame uniform buffer and sets the uniforms that stay the same for
+ * the whole run. Every program that replaces it, as another variant or after a reload, goes through this.
+ */
+void InitProgramUniforms()
+{
+    glslProgram->BindUniformBlock("FrameUniforms", FRAME_UNIFORMS_BINDING);
+    glslProgram->UseProgram();
+
+    if (options.meshSource == MeshSource::Procedural) {
+        glslProgram->GetUniformHandle<glm::ivec2>("gridQuads").Set(glm::ivec2(options.quadsX, options.quadsZ));
+        glslProgram->GetUniformHandle<glm::vec2>("gridSize").Set(glm::vec2(SIZE_X, SIZE_Z));
+    }
+    else if (options.meshSource == MeshSource::Patches) {
+        glslProgram->GetUniformHandle<glm::vec2>("gridScale").Set(lodPatches.GetGridScale());
+        glslProgram->GetUniformHandle<glm::vec2>("gridOffset").Set(lodPatches.GetGridOffset());
+        patchOriginUniform = glslProgram->GetUniformHandle<glm::ivec2>("patchOrigin");
+    }
+    else if (options.emitterCount > 0) {
+        glslProgram->GetUniformHandle<glm::ivec2>("tileCount").Set(glm::ivec2(EMITTER_TILES, EMITTER_TILES));
+        glslProgram->GetUniformHandle<glm::vec2>("gridSize").Set(glm::vec2(SIZE_X, SIZE_Z));
+    }
+    else if (isRippleProgram && options.vertexFormat == VertexFormat::Quantized) {
+        glslProgram->GetUniformHandle<glm::vec2>("gridScale").Set(gridMesh.GetQuantizedScale());
+        glslProgram->GetUniformHandle<glm::vec2>("gridOffset").Set(gridMesh.GetQuantizedOffset());
+    }
+
+    if (options.farFieldEnd > 0.0f) {
+        cameraPositionUniform = glslProgram->GetUniformHandle<glm::vec3>("cameraPosition");
+    }
+
+    if (options.deformPath == DeformPath::Simulation) {
+        glslProgram->GetUniformHandle<int>("heights").Set(static_cast<int>(SIMULATION_HEIGHTS_UNIT));
+        glslProgram->GetUniformHandle<int>("gridColumns").Set(gridMesh.GetQuadsX() + 1);
+        glslProgram->GetUniformHandle<glm::vec2>("gridSpacing").Set(
+                glm::vec2(SIZE_X / gridMesh.GetQuadsX(), SIZE_Z / gridMesh.GetQuadsZ()));
+    }
+
+    if (options.deformPath == DeformPath::Tessellation) {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        viewportSizeUniform = glslProgram->GetUniformHandle<glm::vec2>("viewportSize");
+        viewportSizeUniform.Set(glm::vec2(static_cast<float>(viewport[2]), static_cast<float>(viewport[3])));
+    }
+}
+
+/**
+ * Once every SHADER_POLL_INTERVAL seconds, checks whether the program's shader files changed and, if
+ * they did, has the ProgramBuilder thread build the program again. The new program replaces the one
+ * Render() uses once the builder hands it over, between two frames; a failed build leaves the running
+ * program alone.
+ */
+void UpdateShaderReload()
+{
+    if (programBuilder.IsBuilding()) {
+        std::unique_ptr<GLSLProgram> program;
+        const std::chrono::steady_clock::time_point finishStart = std::chrono::steady_clock::now();
+        if (!programBuilder.TakeProgram(program)) {
+            return;
+        }
+
+        if (program->IsCreated()) {
+            glslProgram = shaderVariants.Replace(programStages, programDefines, std::move(program));
+            InitProgramUniforms();
+            std::cout << "Shaders reloaded, "
+                      << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - finishStart).count()
+                      << " ms on the render thread to switch" << std::endl;
+        }
+        else {
+            std::cerr << "Shader reload failed; keeping the running program" << std::endl;
+        }
+        return;
+    }
+
+    const double now = glfwGetTime();
+    if (now - lastShaderPoll < SHADER_POLL_INTERVAL) {
+        return;
+    }
+    lastShaderPoll = now;
+
+    if (shaderWatcher.Poll()) {
+        programBuilder.Build(programStages, programDefines);
+    }
+}
+
+/**
+ * Points the bound vertex array object at the grid's vertex buffer, for the grid's vertex format, and
+ * at its index buffer. Used for the main context's VAO and for the VAO of every shared window.
+ */
+void SetGridVertexAttributes()
+{
+    glBindBuffer(GL_ARRAY_BUFFER, vboVerticesId);
+    if (gridMesh.GetVertexFormat() == VertexFormat::Quantized) {
+        // Two unsigned shorts per vertex, converted to float without normalization so the column and
+        // row come through exactly; the shader scales them to x/z.
+        glVertexAttribPointer(gridVertexLocation, 2, GL_UNSIGNED_SHORT, GL_FALSE, 2 * sizeof(GLushort), (GLvoid*)0);
+    }
+    else {
+        // Specify how the vertex buffer data should be interpreted whenever a drawing call is made.
+        glVertexAttribPointer(
+                gridVertexLocation, // vertex attribute to configure
+                3,               // size of the vertex attribute; the vertex attribute is a vec3 so it is composed of 3 values
+                GL_FLOAT,        // data is GL_FLOAT (a vec* in GLSL consists of floating point values)
+                GL_FALSE,        // normalize data
+                0,               // no (zero) space between consecutive vertex attribute sets
+                (GLvoid*)0);     // offset of where position data begins in the buffer
+    }
+    glEnableVertexAttribArray(gridVertexLocation);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vboIndicesId);
+}
+
+/**
+ * Opens the further windows of --windows, each turned a step further around the surface, and starts
+ * their threads. The shared objects are finished first, so every context sees them complete.
+ */
+bool StartSharedWindows(GLFWwindow* window)
+{
+    for (int index = 1; index < options.windowCount; ++index) {
+        std::ostringstream title;
+        title << "Ripple Mesh Deformer - display " << index + 1;
+
+        std::unique_ptr<SharedWindow> sharedWindow(new SharedWindow());
+        if (!sharedWindow->Create(window, WIDTH, HEIGHT, title.str().c_str(), 360.0f * index / options.windowCount)) {
+            return false;
+        }
+        glfwSetKeyCallback(sharedWindow->GetWindow(), GlfwKeyCallback);
+        sharedWindows.push_back(std::move(sharedWindow));
+    }
+
+    glFinish();
+    for (size_t index = 0; index < sharedWindows.size(); ++index) {
+        sharedWindows[index]->Start(InitSharedWindowContext, DrawSharedWindow);
+    }
+    std::cout << "Windows: " << options.windowCount << ", sharing one set of buffers and programs" << std::endl;
+    return true;
+}
+
+void StopSharedWindows()
+{
+    for (size_t index = 0; index < sharedWindows.size(); ++index) {
+        std::cout << "Display " << index + 2 << ": " << sharedWindows[index]->GetFrameCount() << " frames" << std::endl;
+        sharedWindows[index]->Destroy();
+    }
+    sharedWindows.clear();
+}
+
+bool IsAnySharedWindowClosing()
+{
+    for (size_t index = 0; index < sharedWindows.size(); ++index) {
+        if (glfwWindowShouldClose(sharedWindows[index]->GetWindow())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Sets up a shared window's context on its thread: the draw state the main context was given, which
+ * belongs to each context, and its VAO over the shared grid buffers.
+ */
+void InitSharedWindowContext()
+{
+    if (options.shading == Shading::Lit) {
+        glEnable(GL_DEPTH_TEST);
+    }
+    else {
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    }
+    if (gridMesh.GetIndexLayout() == IndexLayout::Strips) {
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(gridMesh.GetRestartIndex());
+    }
+    SetGridVertexAttributes();
+}
+
+void DrawSharedWindow()
+{
+    glDrawElements(gridMesh.GetPrimitiveType(), gridMesh.GetIndexCount(), gridMesh.GetIndexType(), static_cast<GLvoid*>(0));
 }
 
 /**
@@ -273,11 +1728,23 @@ GLFWwindow* InitGlfw()
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
 #endif
-    // ... For macOS.
+#if defined(__APPLE__)
+    // ... For macOS, which stops at OpenGL 4.1.
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#else
+    // ... Elsewhere ask for 4.3, which adds the shader storage buffers and compute shaders some modes need.
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
+
+    // Benchmarks render offscreen, and bakes only read back, so their window is never shown.
+    if (options.benchmarkFrames > 0 || options.bakeFrames > 0) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    }
 
     // Create a GLFWwindow object that we can use for GLFW's functions.
     GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Ripple Mesh Deformer", nullptr, nullptr);
@@ -285,12 +1752,14 @@ GLFWwindow* InitGlfw()
 
     // Select the minimum number of monitor refreshes the driver wait should from the time glfwSwapBuffers()
     // was called before swapping the buffers.
-    glfwSwapInterval(1);
+    // Benchmarks and bakes don't wait for any, so the frame rate is not capped by the display.
+    glfwSwapInterval(options.benchmarkFrames > 0 || options.bakeFrames > 0 ? 0 : 1);
 
     // Set the required callback functions.
     glfwSetFramebufferSizeCallback(window, GlfwFramebufferResizeCallback);
     glfwSetWindowRefreshCallback(window, GlfwWindowRefreshCallback);
     glfwSetKeyCallback(window, GlfwKeyCallback);
+    glfwSetMouseButtonCallback(window, GlfwMouseButtonCallback);
     glfwSetErrorCallback(GlfwErrorCallback);
 
     // Set this to true so GLEW knows to use a modern approach to retrieving function pointers and extensions.
@@ -302,6 +1771,11 @@ GLFWwindow* InitGlfw()
         std::cerr << "GLEW initialization error: " << glewGetErrorString(err) << std::endl;
     }
 
+    // Let the driver compile on as many threads as it likes, so each build compiles its stages in parallel.
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+
     return window;
 }
 
@@ -315,6 +1789,11 @@ void GlfwFramebufferResizeCallback(GLFWwindow* window, int width, int height)
                static_cast<GLsizei>(height));
     projectionMatrix = glm::perspective(45.0f, static_cast<GLfloat>(width / height), 1.0f, 1000.0f);
 
+    if (viewportSizeUniform.IsValid()) {
+        glslProgram->UseProgram();
+        viewportSizeUniform.Set(glm::vec2(static_cast<float>(width), static_cast<float>(height)));
+    }
+
     Render(window);
 }
 
@@ -331,6 +1810,78 @@ void GlfwKeyCallback(GLFWwindow* window, int key, int scancode, int action, int
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
         glfwSetWindowShouldClose(window, GL_TRUE);
     }
+
+    // Switch damping on or off; each variant is only compiled the first time. Not with --windows: the
+    // programs they share must not change while they run.
+    if (key == GLFW_KEY_D && action == GLFW_PRESS && isRippleProgram && sharedWindows.empty()) {
+        options.useDamping = !options.useDamping;
+        if (UseRippleVariant()) {
+            std::cout << "Damping " << (options.useDamping ? "on" : "off") << ", " << shaderVariants.GetCount()
+                      << " program variants built" << std::endl;
+        }
+    }
+
+    // Read the captured geometry back, as a physics or collision query would.
+    if (key == GLFW_KEY_R && action == GLFW_PRESS && options.deformPath == DeformPath::TransformFeedback) {
+        std::vector<DeformedVertex> deformedVertices;
+        transformFeedbackDeformer.ReadBack(deformedVertices);
+
+        float minHeight = 0.0f, maxHeight = 0.0f;
+        for (size_t index = 0; index < deformedVertices.size(); ++index) {
+            minHeight = std::min(minHeight, deformedVertices[index].position.y);
+            maxHeight = std::max(maxHeight, deformedVertices[index].position.y);
+        }
+        std::cout << "Read back " << deformedVertices.size() << " vertices, heights from "
+                  << minHeight << " to " << maxHeight << std::endl;
+
+        // Check the captured heights against the CPU reference for the same frame.
+        if (cpuDeformer.GetVertexCount() != deformedVertices.size()) {
+            cpuDeformer.Init(gridMesh.GetQuadsX(), gridMesh.GetQuadsZ(), SIZE_X, SIZE_Z);
+        }
+        cpuDeformer.Deform(frameUniforms, nullptr);
+
+        float maxError = 0.0f;
+        for (size_t index = 0; index < deformedVertices.size(); ++index) {
+            maxError = std::max(maxError, std::fabs(deformedVertices[index].position.y - cpuDeformer.GetHeights()[index]));
+        }
+        std::cout << "Largest difference from the CPU reference: " << maxError << std::endl;
+    }
+}
+
+/**
+ * Called whenever a mouse button is pressed/released via GLFW. A click on the simulated surface drops
+ * a ripple where the ray through the cursor meets the plane.
+ */
+void GlfwMouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+{
+    if (button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS || options.deformPath != DeformPath::Simulation
+            || !options.playbackInput.empty()) {
+        return;
+    }
+
+    double cursorX, cursorY;
+    int width, height;
+    glfwGetCursorPos(window, &cursorX, &cursorY);
+    glfwGetWindowSize(window, &width, &height);
+
+    // Unproject the cursor at the near and far planes with the last frame's transform.
+    const glm::mat4 inverse = glm::inverse(frameUniforms.modelViewProjectMatrix);
+    const float x = static_cast<float>(2.0 * cursorX / width - 1.0);
+    const float y = static_cast<float>(1.0 - 2.0 * cursorY / height);
+    const glm::vec4 nearPoint = inverse * glm::vec4(x, y, -1.0f, 1.0f);
+    const glm::vec4 farPoint = inverse * glm::vec4(x, y, 1.0f, 1.0f);
+    const glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+    const glm::vec3 direction = glm::vec3(farPoint) / farPoint.w - origin;
+
+    // The surface is close enough to y = 0 to aim at the plane.
+    if (direction.y == 0.0f) {
+        return;
+    }
+    const float t = -origin.y / direction.y;
+    const glm::vec3 hit = origin + t * direction;
+    if (t > 0.0f && std::fabs(hit.x) <= SIZE_X / 2.0f && std::fabs(hit.z) <= SIZE_Z / 2.0f) {
+        waveSimulation.AddDrop(glm::vec2(hit.x, hit.z), DROP_RADIUS, DROP_HEIGHT);
+    }
 }
 
 void GlfwErrorCallback(int error, const char* description)